@@ -0,0 +1,87 @@
+// alloc_counter.cpp
+// See alloc_counter.h. The replacements keep the standard behavior (size 0
+// is one byte, failure throws std::bad_alloc or returns nullptr for nothrow).
+// Over-aligned new is left to the library and goes uncounted; nothing in the
+// simulator uses it.
+
+#include "alloc_counter.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+static thread_local std::uint64_t g_threadAllocations = 0;
+
+// -------------------------
+// Global Operator New
+// -------------------------
+void* operator new(std::size_t size) {
+    g_threadAllocations++;
+    for (;;) {
+        if (void* p = std::malloc(size ? size : 1))
+            return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return ::operator new(size);
+    }
+    catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return ::operator new(size, std::nothrow);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+// -------------------------
+// Public Interface
+// -------------------------
+std::uint64_t threadAllocationCount() {
+    return g_threadAllocations;
+}
+
+#ifndef NDEBUG
+void checkNoAllocations(std::uint64_t since, const char* where) {
+    std::uint64_t allocations = g_threadAllocations - since;
+    if (allocations == 0)
+        return;
+    // stdio, not iostream: the report itself must not allocate
+    std::fprintf(stderr, "Error: %llu heap allocations in %s\n", static_cast<unsigned long long>(allocations), where);
+    std::abort();
+}
+#endif
@@ -0,0 +1,24 @@
+// alloc_counter.h
+// Counts heap allocations per thread. alloc_counter.cpp replaces the global
+// operator new (every form that ends up in it: array, nothrow), so linking
+// qg_core is enough; malloc from C libraries (GLFW, the GL driver's C side)
+// is not seen. The count costs one thread-local increment per allocation.
+//
+// Hot paths bracket themselves with it: take threadAllocationCount() at the
+// start and pass it to checkNoAllocations() at the end. In debug builds that
+// logs and aborts when anything was allocated in between; with NDEBUG it
+// compiles to nothing.
+
+#pragma once
+
+#include <cstdint>
+
+// operator new calls made by the calling thread so far
+std::uint64_t threadAllocationCount();
+
+#ifdef NDEBUG
+inline void checkNoAllocations(std::uint64_t, const char*) {}
+#else
+// Aborts, naming where, if the calling thread allocated since since.
+void checkNoAllocations(std::uint64_t since, const char* where);
+#endif
@@ -0,0 +1,511 @@
+// audio_engine.cpp
+// See audio_engine.h. Every patch is rendered ahead of time into a single
+// PCM arena; the callback only mixes slices of it. The callback runs on
+// miniaudio's device thread and never locks or allocates: presses arrive
+// through an SPSC queue, wait in a fixed schedule list until their sample
+// offset falls inside the current buffer and are then played by a fixed pool
+// of voices.
+//
+// Reloaded patches are rendered into a second sample bank on the caller's
+// thread and handed over through an atomic pointer; the callback switches
+// banks at the start of a buffer and gives the old one back once no voice is
+// still playing from it, so a reload never locks, allocates or cuts a click
+// short on the audio thread.
+
+#define MINIAUDIO_IMPLEMENTATION
+#include "miniaudio.h"
+
+#include "audio_engine.h"
+#include "latency_stats.h"
+#include "profiling.h"
+#include "spsc_queue.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// -------------------------
+// Constants
+// -------------------------
+constexpr ma_uint32 AUDIO_SAMPLE_RATE = 48000;
+constexpr ma_uint32 AUDIO_PERIOD_FRAMES = 128; // ~2.7 ms per buffer at 48 kHz
+constexpr int MAX_VOICES = 128;
+constexpr int MAX_CLICK_PATCHES = 16;
+constexpr int SAMPLE_VARIANTS = 4;             // noise takes per patch, played round-robin
+constexpr std::size_t EVENT_QUEUE_CAPACITY = 256;
+constexpr int EVENT_PRODUCER_COUNT = static_cast<int>(EventProducer::COUNT);
+constexpr int MAX_SCHEDULED_EVENTS = 64;
+constexpr float TWO_PI = 6.28318530718f;
+
+// -------------------------
+// Engine State
+// -------------------------
+struct ClickSample {
+    std::int32_t offset = 0;       // first frame inside the sample arena
+    std::int32_t frames = 0;
+};
+
+// Rendered patches. Written only while the audio thread cannot see it.
+struct SampleBank {
+    std::vector<float> arena;
+    ClickSample samples[MAX_CLICK_PATCHES][SAMPLE_VARIANTS];
+    int patchCount = 0;
+};
+
+struct Voice {
+    const float* data = nullptr;   // nullptr marks a free voice
+    const SampleBank* bank = nullptr;
+    std::int32_t frames = 0;
+    std::int32_t position = 0;     // negative while waiting for its start offset
+    float gain = 1.0f;             // press velocity
+};
+
+struct AudioEngine {
+    ma_device device;
+    bool running = false;
+    bool hasDevice = false;        // false in offline mode
+    AudioClock clock = nullptr;
+    float sampleRate = static_cast<float>(AUDIO_SAMPLE_RATE);
+    double scheduleDelay = 0.0;    // fixed press -> playback delay, one device period
+    double outputLatency = 0.0;    // callback -> device output, the device's buffered periods
+
+    // Double-buffered: the callback plays from one bank while a reload
+    // renders into the other.
+    SampleBank banks[2];
+    SampleBank* spareBank = nullptr;                   // caller side; nullptr while the
+                                                       // audio thread still owns both
+    std::atomic<SampleBank*> pendingBank{ nullptr };   // caller -> audio thread
+    std::atomic<SampleBank*> retiredBank{ nullptr };   // audio thread -> caller
+
+    // Audio thread only
+    SampleBank* bank = nullptr;
+    SampleBank* drainingBank = nullptr;                // replaced, voices still playing it
+    Voice voices[MAX_VOICES];
+    int nextVariant = 0;
+    KeyEvent scheduled[MAX_SCHEDULED_EVENTS]; // presses whose offset lies beyond the current buffer
+    int scheduledCount = 0;
+
+    // Input threads -> audio thread, one queue per EventProducer
+    SpscQueue<KeyEvent, EVENT_QUEUE_CAPACITY> events[EVENT_PRODUCER_COUNT];
+
+    // Counters for getAudioEngineStats(), each written by one thread
+    std::atomic<int> activeVoices{ 0 };          // audio thread
+    std::atomic<int> peakVoices{ 0 };            // audio thread
+    std::atomic<std::uint32_t> droppedEvents{ 0 }; // input threads
+};
+
+static AudioEngine g_audio;
+
+// beginAudioEngineInit(): the patches it was given and the thread running
+// initAudioEngine() on them
+struct AudioEngineStartup {
+    std::vector<ClickPatch> patches;
+    AudioClock clock = nullptr;
+    std::thread thread;
+    bool result = false;
+};
+
+static AudioEngineStartup g_audioStartup;
+
+// -------------------------
+// Offline Patch Rendering
+// -------------------------
+struct HighPassCoeffs {
+    float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+};
+
+// RBJ biquad high-pass, the same response as ChucK's HPF.
+static HighPassCoeffs makeHighPass(float freq, float q, float sampleRate) {
+    HighPassCoeffs c;
+    if (freq <= 0.0f || q <= 0.0f)
+        return c;
+    float w0 = TWO_PI * freq / sampleRate;
+    float cosW = std::cos(w0);
+    float alpha = std::sin(w0) / (2.0f * q);
+    float a0 = 1.0f + alpha;
+    c.b0 = (1.0f + cosW) * 0.5f / a0;
+    c.b1 = -(1.0f + cosW) / a0;
+    c.b2 = (1.0f + cosW) * 0.5f / a0;
+    c.a1 = -2.0f * cosW / a0;
+    c.a2 = (1.0f - alpha) / a0;
+    return c;
+}
+
+// ADSR level at time t after keyOn, with keyOff at t == hold.
+// Release ramps linearly from wherever the envelope was at keyOff.
+static float envelopeLevel(const EnvelopeParams& env, float hold, float t) {
+    auto onLevel = [&env](float tt) {
+        if (tt < env.attack)
+            return tt / env.attack;
+        float td = tt - env.attack;
+        if (td < env.decay)
+            return 1.0f - (1.0f - env.sustain) * (td / env.decay);
+        return env.sustain;
+    };
+    if (t < 0.0f)
+        return 0.0f;
+    if (t < hold)
+        return onLevel(t);
+    if (env.release <= 0.0f)
+        return 0.0f;
+    float level = onLevel(hold) * (1.0f - (t - hold) / env.release);
+    return level > 0.0f ? level : 0.0f;
+}
+
+static float nextNoise(std::uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return static_cast<float>(state) * (2.0f / 4294967295.0f) - 1.0f;
+}
+
+static std::int32_t patchFrames(const ClickPatch& patch, float sampleRate) {
+    return static_cast<std::int32_t>(patch.length * sampleRate);
+}
+
+static void renderPatch(const ClickPatch& p, float sampleRate, std::uint32_t seed, float* out, std::int32_t frames) {
+    HighPassCoeffs c = makeHighPass(p.noise.freq, p.noise.q, sampleRate);
+    float x1 = 0.0f, x2 = 0.0f, y1 = 0.0f, y2 = 0.0f;
+    float sinePhase = 0.0f;
+    float sineIncrement = TWO_PI * p.sine.freq / sampleRate;
+    std::uint32_t noiseState = seed | 1u;
+
+    for (std::int32_t i = 0; i < frames; i++) {
+        float t = static_cast<float>(i) / sampleRate;
+        float sample = 0.0f;
+
+        // Noise component
+        float nt = t - p.noise.onset;
+        if (p.noise.gain > 0.0f && nt >= 0.0f) {
+            float x0 = nextNoise(noiseState);
+            float y0 = c.b0 * x0 + c.b1 * x1 + c.b2 * x2 - c.a1 * y1 - c.a2 * y2;
+            x2 = x1; x1 = x0;
+            y2 = y1; y1 = y0;
+            sample += p.noise.gain * y0 * envelopeLevel(p.noise.env, p.noise.hold, nt);
+        }
+
+        // Sine component
+        float st = t - p.sine.onset;
+        if (p.sine.gain > 0.0f && st >= 0.0f) {
+            sample += p.sine.gain * std::sin(sinePhase) * envelopeLevel(p.sine.env, p.sine.hold, st);
+            sinePhase += sineIncrement;
+            if (sinePhase >= TWO_PI)
+                sinePhase -= TWO_PI;
+        }
+        out[i] = sample;
+    }
+}
+
+static void renderSampleBank(SampleBank& bank, const ClickPatch* patches, int patchCount, float sampleRate) {
+    if (patchCount > MAX_CLICK_PATCHES) {
+        std::cerr << "Warning: Only the first " << MAX_CLICK_PATCHES << " click patches are used.\n";
+        patchCount = MAX_CLICK_PATCHES;
+    }
+    std::int32_t totalFrames = 0;
+    for (int i = 0; i < patchCount; i++)
+        totalFrames += patchFrames(patches[i], sampleRate) * SAMPLE_VARIANTS;
+    bank.arena.assign(static_cast<std::size_t>(totalFrames), 0.0f);
+
+    std::int32_t offset = 0;
+    std::uint32_t seed = 0x9E3779B9u;
+    for (int i = 0; i < patchCount; i++) {
+        std::int32_t frames = patchFrames(patches[i], sampleRate);
+        for (int v = 0; v < SAMPLE_VARIANTS; v++) {
+            seed = seed * 1664525u + 1013904223u;
+            renderPatch(patches[i], sampleRate, seed, bank.arena.data() + offset, frames);
+            bank.samples[i][v].offset = offset;
+            bank.samples[i][v].frames = frames;
+            offset += frames;
+        }
+    }
+    bank.patchCount = patchCount;
+}
+
+// -------------------------
+// Voice Pool (audio thread)
+// -------------------------
+// bufferStart is when this callback began; the first sample reaches the
+// device outputLatency after its place in the buffer.
+static void startVoice(const KeyEvent& event, std::int32_t offsetFrames, double bufferStart) {
+    int patchIndex = event.patchIndex;
+    const SampleBank& bank = *g_audio.bank;
+    if (patchIndex < 0 || patchIndex >= bank.patchCount)
+        return;
+    const ClickSample& sample = bank.samples[patchIndex][g_audio.nextVariant];
+    g_audio.nextVariant = (g_audio.nextVariant + 1) % SAMPLE_VARIANTS;
+
+    // Take a free voice, or steal the one that has been playing longest.
+    Voice* target = &g_audio.voices[0];
+    for (auto& v : g_audio.voices) {
+        if (!v.data) {
+            target = &v;
+            break;
+        }
+        if (v.position > target->position)
+            target = &v;
+    }
+    target->data = bank.arena.data() + sample.offset;
+    target->bank = &bank;
+    target->frames = sample.frames;
+    target->position = -offsetFrames;
+    target->gain = event.velocity;
+
+    double firstSampleTime = bufferStart + offsetFrames / g_audio.sampleRate + g_audio.outputLatency;
+    recordLatency(LATENCY_INPUT_TO_AUDIO, firstSampleTime - event.time);
+    markStartupMilestone(STARTUP_FIRST_CLICK);
+}
+
+// Adds the part of the voice that falls inside this buffer.
+static void mixVoice(Voice& v, float* out, std::int32_t frameCount) {
+    std::int32_t start = 0;
+    if (v.position < 0) {
+        start = -v.position;
+        if (start >= frameCount) {
+            v.position += frameCount;
+            return;
+        }
+        v.position = 0;
+    }
+    std::int32_t count = frameCount - start;
+    if (count > v.frames - v.position)
+        count = v.frames - v.position;
+
+    const float* src = v.data + v.position;
+    float* dst = out + start;
+    for (std::int32_t i = 0; i < count; i++)
+        dst[i] += v.gain * src[i];
+
+    v.position += count;
+    if (v.position >= v.frames)
+        v.data = nullptr;
+}
+
+// -------------------------
+// Audio Callback (device thread)
+// -------------------------
+static void audioCallback(ma_device* device, void* output, const void* input, ma_uint32 frameCount) {
+    QG_ZONE("audioCallback");
+    (void)device;
+    (void)input;
+    float* out = static_cast<float*>(output);
+    double bufferStart = g_audio.clock();
+
+    // Buffer boundary: switch to a reloaded bank. Voices already playing keep
+    // reading the old one until they end.
+    if (!g_audio.drainingBank) {
+        SampleBank* next = g_audio.pendingBank.exchange(nullptr, std::memory_order_acquire);
+        if (next) {
+            g_audio.drainingBank = g_audio.bank;
+            g_audio.bank = next;
+        }
+    }
+
+    // Drain the input queues into the schedule list. Releases make no sound.
+    KeyEvent event;
+    for (auto& queue : g_audio.events) {
+        while (g_audio.scheduledCount < MAX_SCHEDULED_EVENTS && queue.pop(event)) {
+            if (event.type == KeyEventType::PRESS)
+                g_audio.scheduled[g_audio.scheduledCount++] = event;
+        }
+    }
+
+    // Start every press that is due within this buffer at its sample offset.
+    for (int i = 0; i < g_audio.scheduledCount;) {
+        const KeyEvent& e = g_audio.scheduled[i];
+        double offset = (e.time + g_audio.scheduleDelay - bufferStart) * g_audio.sampleRate;
+        if (offset >= static_cast<double>(frameCount)) {
+            i++;
+            continue;
+        }
+        startVoice(e, offset > 0.0 ? static_cast<std::int32_t>(offset) : 0, bufferStart);
+        g_audio.scheduled[i] = g_audio.scheduled[--g_audio.scheduledCount];
+    }
+
+    std::int32_t frames = static_cast<std::int32_t>(frameCount);
+    for (std::int32_t i = 0; i < frames; i++)
+        out[i] = 0.0f;
+    bool drainingInUse = false;
+    int active = 0;
+    for (auto& v : g_audio.voices) {
+        if (!v.data)
+            continue;
+        active++;
+        mixVoice(v, out, frames);
+        if (v.data && v.bank == g_audio.drainingBank)
+            drainingInUse = true;
+    }
+    g_audio.activeVoices.store(active, std::memory_order_relaxed);
+    if (active > g_audio.peakVoices.load(std::memory_order_relaxed))
+        g_audio.peakVoices.store(active, std::memory_order_relaxed);
+    if (g_audio.drainingBank && !drainingInUse) {
+        g_audio.retiredBank.store(g_audio.drainingBank, std::memory_order_release);
+        g_audio.drainingBank = nullptr;
+    }
+
+    // Hard clip like the dac would
+    for (std::int32_t i = 0; i < frames; i++) {
+        if (out[i] > 1.0f) out[i] = 1.0f;
+        if (out[i] < -1.0f) out[i] = -1.0f;
+    }
+}
+
+// -------------------------
+// Engine Control
+// -------------------------
+// Everything but the device: timing, a clean voice pool and the first bank.
+// Runs before any callback can, so the callback only ever reads the arena.
+static void prepareEngine(const ClickPatch* patches, int patchCount, AudioClock clock, float sampleRate,
+    ma_uint32 periodFrames, ma_uint32 periods)
+{
+    g_audio.clock = clock;
+    g_audio.sampleRate = sampleRate;
+    g_audio.scheduleDelay = static_cast<double>(periodFrames) / sampleRate;
+    g_audio.outputLatency = static_cast<double>(periodFrames) * periods / sampleRate;
+
+    for (auto& v : g_audio.voices)
+        v = Voice();
+    g_audio.scheduledCount = 0;
+    KeyEvent stale;
+    for (auto& queue : g_audio.events) {
+        while (queue.pop(stale)) {
+        }
+    }
+    g_audio.drainingBank = nullptr;
+    g_audio.pendingBank.store(nullptr);
+    g_audio.retiredBank.store(nullptr);
+    g_audio.activeVoices.store(0);
+    g_audio.peakVoices.store(0);
+    g_audio.droppedEvents.store(0);
+
+    renderSampleBank(g_audio.banks[0], patches, patchCount, sampleRate);
+    g_audio.bank = &g_audio.banks[0];
+    g_audio.spareBank = &g_audio.banks[1];
+}
+
+bool initAudioEngine(const ClickPatch* patches, int patchCount, AudioClock clock) {
+    if (g_audio.running)
+        return true;
+
+    ma_device_config config = ma_device_config_init(ma_device_type_playback);
+    config.playback.format = ma_format_f32;
+    config.playback.channels = 1;
+    config.sampleRate = AUDIO_SAMPLE_RATE;
+    config.periodSizeInFrames = AUDIO_PERIOD_FRAMES;
+    config.performanceProfile = ma_performance_profile_low_latency;
+    config.dataCallback = audioCallback;
+
+    ma_result result = ma_device_init(nullptr, &config, &g_audio.device);
+    if (result != MA_SUCCESS) {
+        std::cerr << "Error: Could not open audio device (" << ma_result_description(result) << ")\n";
+        return false;
+    }
+
+    ma_uint32 periodFrames = g_audio.device.playback.internalPeriodSizeInFrames;
+    if (periodFrames == 0)
+        periodFrames = AUDIO_PERIOD_FRAMES;
+    ma_uint32 periods = g_audio.device.playback.internalPeriods;
+    prepareEngine(patches, patchCount, clock, static_cast<float>(g_audio.device.sampleRate),
+        periodFrames, periods > 0 ? periods : 1);
+
+    result = ma_device_start(&g_audio.device);
+    if (result != MA_SUCCESS) {
+        std::cerr << "Error: Could not start audio device (" << ma_result_description(result) << ")\n";
+        ma_device_uninit(&g_audio.device);
+        return false;
+    }
+    g_audio.hasDevice = true;
+    g_audio.running = true;
+    markStartupMilestone(STARTUP_AUDIO_READY);
+    return true;
+}
+
+void beginAudioEngineInit(const ClickPatch* patches, int patchCount, AudioClock clock) {
+    if (g_audioStartup.thread.joinable())
+        return;
+    g_audioStartup.patches.assign(patches, patches + patchCount);
+    g_audioStartup.clock = clock;
+    try {
+        g_audioStartup.thread = std::thread([] {
+            g_audioStartup.result = initAudioEngine(g_audioStartup.patches.data(),
+                static_cast<int>(g_audioStartup.patches.size()), g_audioStartup.clock);
+        });
+    }
+    catch (const std::system_error&) {
+        // No thread to spare: do it on the way through instead
+        g_audioStartup.result = initAudioEngine(patches, patchCount, clock);
+    }
+}
+
+bool finishAudioEngineInit() {
+    if (g_audioStartup.thread.joinable())
+        g_audioStartup.thread.join();
+    return g_audioStartup.result;
+}
+
+bool initAudioEngineOffline(const ClickPatch* patches, int patchCount, AudioClock clock) {
+    if (g_audio.running)
+        return true;
+    prepareEngine(patches, patchCount, clock, static_cast<float>(AUDIO_SAMPLE_RATE), AUDIO_PERIOD_FRAMES, 1);
+    g_audio.hasDevice = false;
+    g_audio.running = true;
+    return true;
+}
+
+void renderAudioOffline(float* out, std::uint32_t frameCount) {
+    if (g_audio.running && !g_audio.hasDevice)
+        audioCallback(nullptr, out, nullptr, frameCount);
+}
+
+void shutdownAudioEngine() {
+    if (!g_audio.running)
+        return;
+    if (g_audio.hasDevice)
+        ma_device_uninit(&g_audio.device);
+    g_audio.hasDevice = false;
+    g_audio.running = false;
+}
+
+AudioEngineStats getAudioEngineStats() {
+    AudioEngineStats stats;
+    stats.activeVoices = g_audio.activeVoices.load(std::memory_order_relaxed);
+    stats.peakVoices = g_audio.peakVoices.load(std::memory_order_relaxed);
+    stats.droppedEvents = g_audio.droppedEvents.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool reloadClickPatches(const ClickPatch* patches, int patchCount) {
+    if (!g_audio.running)
+        return true; // nothing plays; the next initAudioEngine() renders its own
+    if (!g_audio.spareBank) {
+        // The last reload is handed back once its predecessor's voices end
+        g_audio.spareBank = g_audio.retiredBank.exchange(nullptr, std::memory_order_acquire);
+        if (!g_audio.spareBank)
+            return false;
+    }
+    renderSampleBank(*g_audio.spareBank, patches, patchCount, g_audio.sampleRate);
+    g_audio.pendingBank.store(g_audio.spareBank, std::memory_order_release);
+    g_audio.spareBank = nullptr;
+    return true;
+}
+
+bool submitKeyEvent(const KeyEvent& event, EventProducer producer) {
+    if (!g_audio.running)
+        return false;
+    if (g_audio.events[static_cast<int>(producer)].push(event))
+        return true;
+    g_audio.droppedEvents.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+int submitKeyEvents(const KeyEvent* events, int count, EventProducer producer) {
+    if (!g_audio.running || count <= 0)
+        return 0;
+    int queued = static_cast<int>(g_audio.events[static_cast<int>(producer)].pushBatch(events, count));
+    if (queued < count)
+        g_audio.droppedEvents.fetch_add(count - queued, std::memory_order_relaxed);
+    return queued;
+}
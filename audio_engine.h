@@ -0,0 +1,105 @@
+// audio_engine.h
+// In-process click playback for the keyboard simulators.
+// One playback device (and therefore one audio callback thread) lives for the
+// whole run; a key press only queues an event, it never spawns a process.
+// Patches are rendered ahead of time, so a press costs a buffer copy, not a synth.
+//
+// Requires miniaudio.h (ensure "miniaudio.h" is in your source folder).
+
+#pragma once
+
+#include "key_event.h"
+
+#include <cstdint>
+
+// -------------------------
+// Click Patch Description
+// -------------------------
+// Mirrors the ChucK graphs the simulators used to run per press:
+//   Noise => HPF => ADSR => dac;
+//   SinOsc => ADSR => dac;
+// Times are in seconds, levels are linear gain.
+struct EnvelopeParams {
+    float attack = 0.0f;
+    float decay = 0.0f;
+    float sustain = 0.0f;
+    float release = 0.0f;
+};
+
+struct ClickLayerParams {
+    float gain = 0.0f;   // 0 mutes the layer
+    float freq = 0.0f;   // HPF cutoff (noise layer) or oscillator frequency (sine layer)
+    float q = 1.0f;      // HPF resonance, noise layer only
+    float onset = 0.0f;  // keyOn time relative to the press
+    float hold = 0.0f;   // time between keyOn and keyOff
+    EnvelopeParams env;
+};
+
+struct ClickPatch {
+    ClickLayerParams noise;
+    ClickLayerParams sine;
+    float length = 0.0f; // voice lifetime (the point where the ChucK shred would exit)
+};
+
+// -------------------------
+// Engine Control
+// -------------------------
+// Clock used for KeyEvent::time; must be callable from the audio thread
+// (glfwGetTime is).
+using AudioClock = double (*)();
+
+// Opens the default playback device, renders each patch into the sample arena
+// (KeyEvent::patchIndex selects one) and starts the audio callback thread.
+// Returns false (after logging) if no device could be opened; submitKeyEvent()
+// is then a no-op so the simulator keeps running silently.
+bool initAudioEngine(const ClickPatch* patches, int patchCount, AudioClock clock);
+void shutdownAudioEngine();
+
+// initAudioEngine() on a background thread, so rendering the patches and
+// opening the device overlap window and GL setup (the patches are copied).
+// finishAudioEngineInit() waits for it and returns its result; call it
+// before submitting events or reloading patches, and before
+// shutdownAudioEngine(). clock must already work (glfwInit() done).
+void beginAudioEngineInit(const ClickPatch* patches, int patchCount, AudioClock clock);
+bool finishAudioEngineInit();
+
+// Headless use (benchmarks, replays): everything initAudioEngine() sets up
+// except the device. Nothing plays by itself; each renderAudioOffline() call
+// runs the real audio callback once on the calling thread, which then counts
+// as the audio thread.
+bool initAudioEngineOffline(const ClickPatch* patches, int patchCount, AudioClock clock);
+void renderAudioOffline(float* out, std::uint32_t frameCount);
+
+struct AudioEngineStats {
+    int activeVoices = 0;           // after the last callback
+    int peakVoices = 0;             // since init
+    std::uint32_t droppedEvents = 0; // submitKeyEvent() found a queue full
+};
+AudioEngineStats getAudioEngineStats();
+
+// Replaces the patch set while audio keeps playing. Renders on the calling
+// thread; the audio thread switches over at its next buffer, and clicks that
+// already started finish with the old samples. Returns false without doing
+// anything while the previous reload is still being handed over (at most a
+// few milliseconds); call again later. Call from one thread only.
+bool reloadClickPatches(const ClickPatch* patches, int patchCount);
+
+// Threads that submit key events. Each has a queue of its own, so each may
+// submit without synchronising with the others.
+enum class EventProducer : std::uint8_t {
+    INPUT_CALLBACKS, // the thread that pumps GLFW events
+    RAW_INPUT,       // the raw input listener (raw_input.h)
+    COUNT
+};
+
+// Single producer per EventProducer: call from that thread only. Never blocks
+// or allocates; returns false if the event queue was full and the event
+// dropped. Presses are played one audio buffer after their timestamp, at the
+// exact sample offset, so event polling rate does not show up as click jitter.
+// Each click started records LATENCY_INPUT_TO_AUDIO (latency_stats.h).
+bool submitKeyEvent(const KeyEvent& event, EventProducer producer = EventProducer::INPUT_CALLBACKS);
+
+// submitKeyEvent() for several events at once (a drag's crossed keys): one
+// queue publish instead of one per event. Returns how many were queued;
+// the rest were dropped.
+int submitKeyEvents(const KeyEvent* events, int count, EventProducer producer = EventProducer::INPUT_CALLBACKS);
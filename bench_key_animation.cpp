@@ -0,0 +1,127 @@
+// bench_key_animation.cpp
+// Micro-benchmark for the per-frame press animation step: the old per-key
+// update over std::vector<Key> (label string, geometry and state interleaved)
+// against the structure-of-arrays store in key_state.h, scalar and SIMD, and
+// the closed-form evaluation the board uses (linear curve), which only visits
+// keys in motion.
+//
+// Build and run (no GL needed):
+//   g++ -O2 -std=c++17 bench_key_animation.cpp key_state.cpp -o bench_key_animation
+//   cl /O2 /EHsc bench_key_animation.cpp key_state.cpp
+
+#include "key_state.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Old layout of Key (keyboard.h before the state split)
+struct LegacyKey {
+    std::string label;
+    float pos[2];
+    float size[2];
+    float pressAnim = 0.0f;
+    bool isPressed = false;
+    bool keycapRemoved = false;
+    int type = 0;
+};
+
+static bool updateLegacyKey(LegacyKey& key, float step) {
+    float before = key.pressAnim;
+    float target = key.isPressed ? 0.5f : 0.0f;
+    if (key.pressAnim < target) {
+        key.pressAnim += step;
+        if (key.pressAnim > target) key.pressAnim = target;
+    }
+    else if (key.pressAnim > target) {
+        key.pressAnim -= step;
+        if (key.pressAnim < target) key.pressAnim = target;
+    }
+    return key.pressAnim != target || key.pressAnim != before;
+}
+
+// Every key is re-targeted every 20 frames, half of them pressed, so the
+// kernels always have keys in motion.
+static bool pressedAt(std::size_t key, int frame) {
+    return ((key * 7 + frame / 20) & 1) != 0;
+}
+
+using Clock = std::chrono::steady_clock;
+
+template<typename Fn>
+static double nanosPerKey(std::size_t keys, int frames, Fn&& frame) {
+    Clock::time_point start = Clock::now();
+    for (int f = 0; f < frames; f++)
+        frame(f);
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    return ns / (static_cast<double>(keys) * frames);
+}
+
+int main() {
+    const double frameTime = 1.0 / 240.0; // 240 Hz frames
+    const float step = 0.5f / 0.15f * static_cast<float>(frameTime);
+    volatile bool sink = false;
+
+    std::printf("%8s %14s %14s %14s %14s   (ns per key per frame)\n", "keys", "AoS Key", "SoA scalar", "SoA SIMD",
+        "analytic");
+    for (std::size_t keys : { 100u, 1000u, 10000u, 100000u }) {
+        int frames = static_cast<int>(20000000 / keys);
+
+        std::vector<LegacyKey> legacy(keys);
+        for (std::size_t i = 0; i < keys; i++)
+            legacy[i].label = "Key " + std::to_string(i);
+        KeyStates scalar, simd, analytic;
+        resetKeyStates(scalar, keys);
+        resetKeyStates(simd, keys);
+        resetKeyStates(analytic, keys);
+
+        double aos = nanosPerKey(keys, frames, [&](int f) {
+            if (f % 20 == 0) {
+                for (std::size_t i = 0; i < keys; i++)
+                    legacy[i].isPressed = pressedAt(i, f);
+            }
+            bool moving = false;
+            for (std::size_t i = 0; i < keys; i++)
+                moving |= updateLegacyKey(legacy[i], step);
+            sink = moving;
+        });
+        double soaScalar = nanosPerKey(keys, frames, [&](int f) {
+            if (f % 20 == 0) {
+                for (std::size_t i = 0; i < keys; i++)
+                    setKeyPressed(scalar, i, pressedAt(i, f));
+            }
+            sink = stepKeyAnimationsScalar(scalar, step);
+        });
+        double soaSimd = nanosPerKey(keys, frames, [&](int f) {
+            if (f % 20 == 0) {
+                for (std::size_t i = 0; i < keys; i++)
+                    setKeyPressed(simd, i, pressedAt(i, f));
+            }
+            sink = stepKeyAnimations(simd, step);
+        });
+        double soaAnalytic = nanosPerKey(keys, frames, [&](int f) {
+            // A step covers the frame before it, so frame f shows time f + 1
+            double now = (f + 1) * frameTime;
+            if (f % 20 == 0) {
+                for (std::size_t i = 0; i < keys; i++) {
+                    if (isKeyPressed(analytic, i) != pressedAt(i, f))
+                        animateKeyTo(analytic, i, pressedAt(i, f), f * frameTime);
+                }
+            }
+            sink = evaluateKeyAnimations(analytic, now);
+        });
+
+        // The stepping kernels must agree exactly, the closed form up to rounding
+        for (std::size_t i = 0; i < keys; i++) {
+            if (legacy[i].pressAnim != scalar.pressAnim[i] || scalar.pressAnim[i] != simd.pressAnim[i]
+                || std::fabs(simd.pressAnim[i] - analytic.pressAnim[i]) > 1e-4f) {
+                std::printf("Error: results differ at key %zu\n", i);
+                return 1;
+            }
+        }
+        std::printf("%8zu %14.3f %14.3f %14.3f %14.3f\n", keys, aos, soaScalar, soaSimd, soaAnalytic);
+    }
+    return 0;
+}
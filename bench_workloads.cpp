@@ -0,0 +1,434 @@
+// bench_workloads.cpp
+// Headless benchmark: replays scripted input through the simulator's real
+// GLFW callbacks (board.cpp) on a virtual timeline and runs the real audio
+// engine offline, one frame at a time. Workloads:
+//   typing_150wpm   letters and spaces at 150 WPM with human-ish jitter
+//   rollover_20key  20 keys mashed down together four times a second
+//   row_drags       left-button drags across every row, 1000 Hz cursor
+//   row_swipes      the same drags in 50 ms with a 125 Hz cursor, so every
+//                   cursor step jumps several keys
+//   replay          a session recorded with main --record (--replay <log>)
+// Reports frame time, input events per second of dispatch time, audio voice
+// counts and heap allocations per event / per frame. Typing stats and the
+// heatmap run throughout (unflushed), so their cost is part of every event.
+// Dispatch and frames must not allocate at all (the check debug builds of
+// the simulator make, alloc_counter.h): any workload that does fails the run.
+//
+// By default nothing is drawn (null renderer), so frame time is the CPU side
+// of a frame. --gl draws every frame through keyboard_renderer into a hidden
+// window, latency overlay included, and waits for it with glFinish.
+//
+// Build with CMake (`cmake --build build --target bench` runs it), or by hand
+// from the source folder, so layouts/ resolves:
+//   g++ -O2 -std=c++17 bench_workloads.cpp alloc_counter.cpp board.cpp audio_engine.cpp click_patches.cpp gl_functions.cpp input_log.cpp keyboard_renderer.cpp label_atlas.cpp key_hit_grid.cpp key_state.cpp latency_stats.cpp layout.cpp raw_input.cpp switch_profiles.cpp typing_stats.cpp -lglfw -lGL -ldl -lpthread -o bench_workloads
+//   cl /O2 /EHsc bench_workloads.cpp alloc_counter.cpp board.cpp audio_engine.cpp click_patches.cpp gl_functions.cpp input_log.cpp keyboard_renderer.cpp label_atlas.cpp key_hit_grid.cpp key_state.cpp latency_stats.cpp layout.cpp raw_input.cpp switch_profiles.cpp typing_stats.cpp /I"path_to_glm" /I"path_to_stb" /I"path_to_miniaudio" /link glfw3.lib opengl32.lib user32.lib gdi32.lib
+//   ./bench_workloads [--layout <file>] [--seconds <s>] [--hz <fps>] [--gl] [--replay <log>]
+
+#include "gl_functions.h"
+#include "alloc_counter.h"
+#include "audio_engine.h"
+#include "board.h"
+#include "input_log.h"
+#include "keyboard_renderer.h"
+#include "latency_stats.h"
+#include "layout.h"
+#include "profiling.h"
+#include "switch_profiles.h"
+#include "typing_stats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// -------------------------
+// Virtual Timeline
+// -------------------------
+// Both the input callbacks and the audio engine read this clock, so runs are
+// deterministic and independent of how fast the machine replays them.
+static double g_virtualTime = 0.0;
+
+static double virtualClock() {
+    return g_virtualTime;
+}
+
+constexpr int VIRTUAL_WINDOW_WIDTH = 1920;
+constexpr int VIRTUAL_WINDOW_HEIGHT = 1080;
+constexpr std::uint32_t AUDIO_CHUNK_FRAMES = 128;
+constexpr double AUDIO_RATE = 48000.0;
+
+// -------------------------
+// Scripted Input
+// -------------------------
+// Scripts are built as input log records, so synthetic and recorded
+// workloads replay through the same path.
+// Small deterministic generator so every run replays the same script
+struct ScriptRandom {
+    std::uint32_t state = 0x12345678u;
+    double next() {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<double>(state >> 8) / 16777216.0;
+    }
+    double range(double lo, double hi) {
+        return lo + (hi - lo) * next();
+    }
+};
+
+static void addKey(std::vector<InputRecord>& script, double time, int key, int action) {
+    InputRecord e;
+    e.time = time;
+    e.type = InputRecordType::KEY;
+    e.code = key;
+    e.action = static_cast<std::uint8_t>(action);
+    script.push_back(e);
+}
+
+static void addMouse(std::vector<InputRecord>& script, double time, InputRecordType type, int action,
+    double x, double y)
+{
+    InputRecord e;
+    e.time = time;
+    e.type = type;
+    e.code = GLFW_MOUSE_BUTTON_LEFT;
+    e.action = static_cast<std::uint8_t>(action);
+    e.x = x;
+    e.y = y;
+    script.push_back(e);
+}
+
+// 150 words per minute at 5 characters a word: one key every 80 ms on average
+static std::vector<InputRecord> makeTypingScript(double seconds) {
+    static const char TEXT[] = "the quick brown fox jumps over the lazy dog ";
+    std::vector<InputRecord> script;
+    ScriptRandom rng;
+    double interval = 60.0 / (150.0 * 5.0);
+    double t = 0.0;
+    for (int i = 0; t < seconds; i++) {
+        char c = TEXT[i % (sizeof(TEXT) - 1)];
+        int key = c == ' ' ? GLFW_KEY_SPACE : GLFW_KEY_A + (c - 'a');
+        double hold = rng.range(0.06, 0.11);
+        addKey(script, t, key, GLFW_PRESS);
+        addKey(script, t + hold, key, GLFW_RELEASE);
+        t += interval * rng.range(0.75, 1.25);
+    }
+    return script;
+}
+
+// Every 250 ms, 20 different mapped keys go down within 15 ms, are held
+// for 60 ms and come back up within 15 ms.
+static std::vector<InputRecord> makeRolloverScript(double seconds) {
+    std::vector<int> codes;
+    for (int code = 0; code <= GLFW_KEY_LAST; code++) {
+        if (glfwKeyToIndex[code] != UNMAPPED_KEY)
+            codes.push_back(code);
+    }
+    std::vector<InputRecord> script;
+    if (codes.empty())
+        return script;
+    ScriptRandom rng;
+    std::size_t next = 0;
+    for (double t = 0.0; t < seconds; t += 0.25) {
+        for (int k = 0; k < 20; k++) {
+            int code = codes[(next + k * 7) % codes.size()];
+            addKey(script, t + rng.range(0.0, 0.015), code, GLFW_PRESS);
+            addKey(script, t + 0.075 + rng.range(0.0, 0.015), code, GLFW_RELEASE);
+        }
+        next += 3;
+    }
+    return script;
+}
+
+// Drags along the middle of every row of keys, left to right in duration
+// seconds with the cursor reported at sampleRate, one drag every 500 ms.
+static std::vector<InputRecord> makeDragScript(double seconds, double duration, int sampleRate) {
+    struct Row {
+        float y, x0, x1;
+    };
+    std::vector<Row> rows;
+    for (const Key& k : keyboardKeys) {
+        float y = k.pos.y + k.size.y * 0.5f;
+        auto it = std::find_if(rows.begin(), rows.end(), [&](const Row& r) { return r.y == y; });
+        if (it == rows.end())
+            rows.push_back({ y, k.pos.x, k.pos.x + k.size.x });
+        else {
+            it->x0 = std::min(it->x0, k.pos.x);
+            it->x1 = std::max(it->x1, k.pos.x + k.size.x);
+        }
+    }
+    std::vector<InputRecord> script;
+    if (rows.empty())
+        return script;
+    for (std::size_t r = 0; r * 0.5 < seconds; r++) {
+        const Row& row = rows[r % rows.size()];
+        double start = r * 0.5;
+        addMouse(script, start, InputRecordType::CURSOR, 0, row.x0 + 1.0, row.y);
+        addMouse(script, start, InputRecordType::MOUSE_BUTTON, GLFW_PRESS, row.x0 + 1.0, row.y);
+        int samples = static_cast<int>(duration * sampleRate);
+        for (int i = 1; i <= samples; i++) {
+            double along = static_cast<double>(i) / samples; // exactly 1 at the release
+            double x = row.x0 + 1.0 + (row.x1 - row.x0 - 2.0) * along;
+            addMouse(script, start + duration * along, InputRecordType::CURSOR, 0, x, row.y);
+        }
+        addMouse(script, start + duration, InputRecordType::MOUSE_BUTTON, GLFW_RELEASE, row.x1 - 1.0, row.y);
+    }
+    return script;
+}
+
+// -------------------------
+// Replay
+// -------------------------
+struct WorkloadResult {
+    std::size_t events = 0;
+    int frames = 0;
+    double dispatchSeconds = 0.0;   // wall time spent inside the callbacks
+    std::vector<double> frameSeconds;
+    double audioSeconds = 0.0;
+    int audioBuffers = 0;
+    double voiceSum = 0.0;
+    int peakVoices = 0;
+    std::uint32_t droppedEvents = 0;
+    std::uint64_t eventAllocations = 0;
+    std::uint64_t frameAllocations = 0;
+};
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// There is no render thread here, so the benchmark stands in for it: every
+// frame it finishes is the one that shows the presses since the last.
+static void notePresentedFrame(double presentTime) {
+    for (double pressTime : g_pendingPhotons)
+        recordLatency(LATENCY_INPUT_TO_PHOTON, presentTime - pressTime);
+    g_pendingPhotons.clear();
+}
+
+static WorkloadResult runWorkload(std::vector<InputRecord> script, double seconds, double frameRate,
+    GLFWwindow* window)
+{
+    std::stable_sort(script.begin(), script.end(),
+        [](const InputRecord& a, const InputRecord& b) { return a.time < b.time; });
+
+    WorkloadResult result;
+    double frameTime = 1.0 / frameRate;
+    int frameCount = static_cast<int>(seconds * frameRate);
+    result.frameSeconds.reserve(frameCount);
+    std::vector<float> audio(AUDIO_CHUNK_FRAMES);
+    char overlayText[LATENCY_REPORT_CAPACITY];
+    double audioTime = 0.0;
+    std::size_t next = 0;
+
+    for (int f = 0; f < frameCount; f++) {
+        double frameEnd = (f + 1) * frameTime;
+
+        // What glfwPollEvents would deliver before this frame
+        std::uint64_t before = threadAllocationCount();
+        auto start = std::chrono::steady_clock::now();
+        std::size_t first = next;
+        while (next < script.size() && script[next].time < frameEnd)
+        {
+            g_virtualTime = script[next].time;
+            replayInputRecord(script[next++]);
+        }
+        flushCursorDrag();
+        result.dispatchSeconds += secondsSince(start);
+        result.events += next - first;
+        result.eventAllocations += threadAllocationCount() - before;
+
+        // The frame itself
+        g_virtualTime = frameEnd;
+        before = threadAllocationCount();
+        start = std::chrono::steady_clock::now();
+        updateKeyAnimations(g_keyStates, g_virtualTime);
+        if (window) {
+            drawKeyboard(g_keyStates);
+            formatLatencyReport(overlayText, sizeof(overlayText));
+            drawOverlayText(overlayText, 10.0f, 10.0f, glm::vec3(1.0f));
+            glFinish();
+        }
+        notePresentedFrame(g_virtualTime);
+        QG_FRAME_MARK();
+        result.frameSeconds.push_back(secondsSince(start));
+        result.frameAllocations += threadAllocationCount() - before;
+
+        // Audio for the same stretch of the timeline, one device period at a time
+        while (audioTime < frameEnd) {
+            g_virtualTime = audioTime;
+            start = std::chrono::steady_clock::now();
+            renderAudioOffline(audio.data(), AUDIO_CHUNK_FRAMES);
+            result.audioSeconds += secondsSince(start);
+            result.audioBuffers++;
+            audioTime += AUDIO_CHUNK_FRAMES / AUDIO_RATE;
+        }
+        AudioEngineStats stats = getAudioEngineStats();
+        result.voiceSum += stats.activeVoices;
+        result.peakVoices = stats.peakVoices;
+        result.droppedEvents = stats.droppedEvents;
+        result.frames++;
+    }
+    return result;
+}
+
+static void printResult(const char* name, WorkloadResult& r) {
+    std::sort(r.frameSeconds.begin(), r.frameSeconds.end());
+    double sum = 0.0;
+    for (double s : r.frameSeconds)
+        sum += s;
+    double mean = r.frameSeconds.empty() ? 0.0 : sum / r.frameSeconds.size();
+    double p99 = r.frameSeconds.empty() ? 0.0 : r.frameSeconds[r.frameSeconds.size() * 99 / 100];
+    double worst = r.frameSeconds.empty() ? 0.0 : r.frameSeconds.back();
+    double eventsPerSecond = r.dispatchSeconds > 0.0 ? r.events / r.dispatchSeconds : 0.0;
+    double audioMicros = r.audioBuffers ? r.audioSeconds / r.audioBuffers * 1e6 : 0.0;
+    double allocsPerEvent = r.events ? static_cast<double>(r.eventAllocations) / r.events : 0.0;
+    double allocsPerFrame = r.frames ? static_cast<double>(r.frameAllocations) / r.frames : 0.0;
+
+    std::printf("%-16s %8zu %12.3g %9.4f %9.4f %9.4f %9.2f %6.1f %5d %7.3f %8.3f %7u\n", name, r.events,
+        eventsPerSecond, mean * 1e3, p99 * 1e3, worst * 1e3, audioMicros,
+        r.frames ? r.voiceSum / r.frames : 0.0, r.peakVoices, allocsPerEvent, allocsPerFrame, r.droppedEvents);
+}
+
+// -------------------------
+// Main
+// -------------------------
+int main(int argc, char** argv) {
+    std::string layoutPath = "layouts/full_board.layout";
+    double seconds = 20.0;
+    double frameRate = 60.0;
+    bool useGl = false;
+    std::string replayPath;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--layout") == 0 && i + 1 < argc)
+            layoutPath = argv[++i];
+        else if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+            seconds = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--hz") == 0 && i + 1 < argc)
+            frameRate = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--gl") == 0)
+            useGl = true;
+        else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+            replayPath = argv[++i];
+        else
+            std::fprintf(stderr, "Warning: Ignoring unknown option %s\n", argv[i]);
+    }
+    if (seconds <= 0.0 || frameRate <= 0.0) {
+        std::fprintf(stderr, "Error: --seconds and --hz must be positive\n");
+        return 1;
+    }
+
+    // A recorded session replays alone, on the timeline and in the window
+    // size it was recorded with
+    int windowWidth = VIRTUAL_WINDOW_WIDTH;
+    int windowHeight = VIRTUAL_WINDOW_HEIGHT;
+    InputLog replay;
+    if (!replayPath.empty()) {
+        if (!loadInputLog(replayPath, replay))
+            return 1;
+        for (InputRecord& r : replay.records)
+            r.time -= replay.startTime;
+        seconds = replay.records.empty() ? 0.0 : replay.records.back().time + PRESS_FEEDBACK_DURATION;
+        if (replay.windowWidth > 0 && replay.windowHeight > 0) {
+            windowWidth = replay.windowWidth;
+            windowHeight = replay.windowHeight;
+        }
+    }
+
+    Layout layout;
+    if (!loadLayout(layoutPath, layout))
+        return 1;
+    glm::vec2 origin = computeBoardOrigin(*layout.header, windowWidth, windowHeight);
+    applyLayout(layout, origin.x, origin.y);
+    g_inputClock = virtualClock;
+
+    // Offscreen context: a hidden window the size of the virtual one
+    GLFWwindow* window = nullptr;
+    if (useGl) {
+        if (!glfwInit()) {
+            std::fprintf(stderr, "Error: Failed to initialize GLFW\n");
+            return 1;
+        }
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        window = glfwCreateWindow(windowWidth, windowHeight, "bench", nullptr, nullptr);
+        if (!window) {
+            std::fprintf(stderr, "Error: Failed to create a hidden GLFW window\n");
+            glfwTerminate();
+            return 1;
+        }
+        glfwMakeContextCurrent(window);
+        glfwSwapInterval(0);
+        if (!loadGLFunctions() || !initKeyboardRenderer()) {
+            glfwTerminate();
+            return 1;
+        }
+        glMatrixMode(GL_PROJECTION);
+        glLoadIdentity();
+        glOrtho(0, windowWidth, windowHeight, 0, -100, 100);
+        glMatrixMode(GL_MODELVIEW);
+        glLoadIdentity();
+        const float* bg = layout.header->background;
+        glClearColor(bg[0], bg[1], bg[2], 1.0f);
+    }
+
+    ClickPatch patches[SWITCH_PROFILE_COUNT];
+    collectClickPatches(builtinSwitchProfiles(), SWITCH_PROFILE_COUNT, patches);
+
+    std::printf("%s, %zu keys, %.0f Hz frames, %.0f s per workload, %s renderer\n", layoutPath.c_str(),
+        keyboardKeys.size(), frameRate, seconds, window ? "GL" : "null");
+    std::printf("%-16s %8s %12s %9s %9s %9s %9s %6s %5s %7s %8s %7s\n", "workload", "events", "events/s",
+        "frame ms", "p99 ms", "max ms", "audio us", "voices", "peak", "allc/ev", "allc/frm", "dropped");
+
+    enum Workload { TYPING, ROLLOVER, DRAGS, SWIPES, REPLAY, WORKLOAD_COUNT };
+    static const char* const NAMES[WORKLOAD_COUNT] = { "typing_150wpm", "rollover_20key", "row_drags", "row_swipes",
+        "replay" };
+    int firstWorkload = replayPath.empty() ? TYPING : REPLAY;
+    int lastWorkload = replayPath.empty() ? SWIPES : REPLAY;
+    int allocatingWorkloads = 0;
+    for (int w = firstWorkload; w <= lastWorkload; w++) {
+        // Fresh board, queue and voice pool for every workload
+        applyLayout(layout, origin.x, origin.y);
+        g_leftMouseDown = false;
+        g_dragKeyIndex = -1;
+        if (window) {
+            buildKeyboardMesh(keyboardKeys, layout.header->keyDepth, builtinSwitchProfiles(), SWITCH_PROFILE_COUNT);
+            buildKeyboardLabels(keyboardKeys, computeLabelAnchors());
+            setKeyboardTarget(windowWidth, windowHeight, 1.0f);
+        }
+        g_virtualTime = 0.0;
+        initAudioEngineOffline(patches, SWITCH_PROFILE_COUNT, virtualClock);
+        startTypingStats(keyboardKeys, "");
+        g_showHeatmap = true;
+
+        std::vector<InputRecord> script;
+        if (w == TYPING)
+            script = makeTypingScript(seconds);
+        else if (w == ROLLOVER)
+            script = makeRolloverScript(seconds);
+        else if (w == DRAGS)
+            script = makeDragScript(seconds, 0.4, 1000);
+        else if (w == SWIPES)
+            script = makeDragScript(seconds, 0.05, 125);
+        else
+            script = replay.records;
+        WorkloadResult result = runWorkload(script, seconds, frameRate, window);
+        printResult(NAMES[w], result);
+        if (result.eventAllocations || result.frameAllocations) {
+            std::fprintf(stderr, "Error: %s allocated on the hot path (%llu in dispatch, %llu in frames)\n", NAMES[w],
+                static_cast<unsigned long long>(result.eventAllocations),
+                static_cast<unsigned long long>(result.frameAllocations));
+            allocatingWorkloads++;
+        }
+        stopTypingStats();
+        shutdownAudioEngine();
+    }
+
+    if (window) {
+        shutdownKeyboardRenderer();
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
+    closeLayout(layout);
+    return allocatingWorkloads ? 1 : 0;
+}
@@ -0,0 +1,422 @@
+// board.cpp
+// See board.h.
+
+#include "board.h"
+
+#include "audio_engine.h"
+#include "input_log.h"
+#include "profiling.h"
+#include "raw_input.h"
+#include "typing_stats.h"
+
+#include <GLFW/glfw3.h>
+#include <algorithm>
+
+// -------------------------
+// Board State
+// -------------------------
+std::vector<Key> keyboardKeys;
+KeyStates g_keyStates;
+std::array<std::int16_t, GLFW_KEY_LAST + 1> glfwKeyToIndex;
+std::vector<std::uint8_t> g_keyHoldCount;
+std::vector<std::uint8_t> g_mirrorHoldCount;
+KeyHitGrid g_keyGrid;
+bool g_leftMouseDown = false;
+int g_dragKeyIndex = -1;
+double g_cursorX = 0.0, g_cursorY = 0.0;
+bool g_needsRedraw = true;
+bool g_showHeatmap = false;
+std::vector<double> g_pendingPhotons;
+InputClock g_inputClock = glfwGetTime;
+
+// Local presses and releases since the last collectLocalKeyBits(), one bit
+// per key. Sized in applyLayout.
+static std::vector<std::uint64_t> s_localKeyChanged;
+static bool s_applyingMirror = false; // postKeyEvent: not a local change
+
+// Cursor drag: samples since the last flushCursorDrag(), and where the
+// processed part of the path ends
+constexpr int DRAG_SAMPLE_CAPACITY = 64;  // samples held before an early flush
+constexpr int DRAG_MAX_CROSSED = 64;      // keys one sample-to-sample segment can cross
+constexpr int DRAG_BATCH_CAPACITY = 128;  // clicks per audio submission
+
+struct CursorSample {
+    double x, y, time;
+};
+static CursorSample s_dragSamples[DRAG_SAMPLE_CAPACITY];
+static int s_dragSampleCount = 0;
+static CursorSample s_dragLast = {};
+static KeyEvent s_dragBatch[DRAG_BATCH_CAPACITY];
+static int s_dragBatchCount = 0;
+static bool s_batchingDrag = false; // postKeyEvent: collect into s_dragBatch
+
+// -------------------------
+// Label Placement & Animation
+// -------------------------
+std::vector<glm::vec2> computeLabelAnchors() {
+    std::vector<glm::vec2> anchors;
+    anchors.reserve(keyboardKeys.size());
+    for (const auto& k : keyboardKeys)
+        anchors.push_back(k.pos + k.labelPos);
+    return anchors;
+}
+
+bool updateKeyAnimations(KeyStates& states, double now) {
+    QG_ZONE("updateKeyAnimations");
+    return evaluateKeyAnimations(states, now);
+}
+
+// -------------------------
+// Keyboard Layout
+// -------------------------
+// Map a GLFW keycode to a key; a layout's aliases map more codes to one key
+static void mapGlfwKey(int glfwKey, int index) {
+    if (glfwKey >= 0 && glfwKey <= GLFW_KEY_LAST)
+        glfwKeyToIndex[glfwKey] = static_cast<std::int16_t>(index);
+}
+
+void applyLayout(const Layout& layout, float originX, float originY) {
+    keyboardKeys.clear();
+    g_keyHoldCount.clear();
+    glfwKeyToIndex.fill(UNMAPPED_KEY);
+
+    float cellSize = 0.0f;
+    for (std::uint32_t i = 0; i < layout.header->keyCount; i++) {
+        const LayoutKeyRecord& r = layout.keys[i];
+        Key k;
+        k.label = layoutString(layout, r.labelOffset, r.labelLength);
+        k.pos = glm::vec2(originX + r.x, originY + r.y);
+        k.size = glm::vec2(r.width, r.height);
+        k.labelPos = glm::vec2(r.labelX, r.labelY);
+        k.type = static_cast<KeyType>(r.type);
+        k.switchId = r.switchId;
+        keyboardKeys.push_back(k);
+        g_keyHoldCount.push_back(0);
+        if (r.glfwKey != -1)
+            mapGlfwKey(r.glfwKey, static_cast<int>(i));
+        if (cellSize == 0.0f || r.height < cellSize)
+            cellSize = r.height;
+    }
+    for (std::uint32_t a = 0; a < layout.header->aliasCount; a++)
+        mapGlfwKey(layout.aliases[a].glfwKey, static_cast<int>(layout.aliases[a].keyIndex));
+
+    buildKeyHitGrid(g_keyGrid, keyboardKeys, cellSize);
+    g_keyStates.travelTime = static_cast<float>(PRESS_FEEDBACK_DURATION);
+    resetKeyStates(g_keyStates, keyboardKeys.size());
+    g_pendingPhotons.clear();
+    g_pendingPhotons.reserve(keyboardKeys.size() * 2);
+    g_mirrorHoldCount.assign(keyboardKeys.size(), 0);
+    s_dragSampleCount = 0;
+    s_localKeyChanged.assign((keyboardKeys.size() + 63) / 64, 0);
+}
+
+glm::vec2 computeBoardOrigin(const LayoutHeader& board, int windowWidth, int windowHeight) {
+    glm::vec2 origin(board.originX, board.originY);
+    if (board.centerWidth > 0.0f) {
+        origin.x += (windowWidth - board.centerWidth) / 2.0f;
+        origin.y += (windowHeight - board.centerHeight) / 2.0f;
+    }
+    return origin;
+}
+
+// -------------------------
+// Audio Event Hand-off
+// -------------------------
+// Callbacks stamp the event at entry so the audio thread can place the click
+// at the right sample no matter when glfwPollEvents got around to dispatching
+// it. playClick is false for presses the raw input listener already played.
+static void submitDragBatch() {
+    submitKeyEvents(s_dragBatch, s_dragBatchCount);
+    s_dragBatchCount = 0;
+}
+
+static void postKeyEvent(int index, KeyEventType type, double time, bool playClick = true) {
+    if (playClick) {
+        KeyEvent e;
+        e.time = time;
+        e.keyIndex = index;
+        e.type = type;
+        e.patchIndex = keyboardKeys[index].switchId; // profile ids are patch indices
+        if (!s_batchingDrag)
+            submitKeyEvent(e);
+        else {
+            if (s_dragBatchCount == DRAG_BATCH_CAPACITY)
+                submitDragBatch();
+            s_dragBatch[s_dragBatchCount++] = e;
+        }
+    }
+    g_needsRedraw = true;
+    if (!s_applyingMirror)
+        s_localKeyChanged[index / 64] |= std::uint64_t(1) << (index % 64);
+    if (type == KeyEventType::PRESS && g_pendingPhotons.size() < g_pendingPhotons.capacity())
+        g_pendingPhotons.push_back(time);
+}
+
+// A key goes up only once nothing holds it: a physical key, a mirrored
+// board, or the left mouse button (g_dragKeyIndex while it is down).
+static bool isKeyHeld(int index) {
+    return g_keyHoldCount[index] > 0 || g_mirrorHoldCount[index] > 0
+        || (g_leftMouseDown && index == g_dragKeyIndex);
+}
+
+// -------------------------
+// GLFW Key Callback
+// -------------------------
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    double eventTime = g_inputClock();
+    InputRecord record;
+    record.time = eventTime;
+    record.type = InputRecordType::KEY;
+    record.code = key;
+    record.scancode = scancode;
+    record.action = static_cast<std::uint8_t>(action);
+    record.mods = static_cast<std::uint16_t>(mods);
+    recordInput(record);
+
+    if (key < 0 || key > GLFW_KEY_LAST)
+        return; // GLFW_KEY_UNKNOWN
+    int index = glfwKeyToIndex[key];
+    if (index == UNMAPPED_KEY)
+        return;
+
+    if (action == GLFW_PRESS) {
+        if (g_keyHoldCount[index]++ == 0) {
+            // The raw listener may have played it already, with the OS's
+            // timestamp. Replayed presses are not its business.
+            double rawTime = eventTime;
+            bool voiced = window && claimRawPress(index, rawTime);
+            if (voiced && rawTime < eventTime)
+                eventTime = rawTime;
+            // The mouse or a mirrored board may have it down already: one
+            // click per key, but the typing stats still see the finger
+            if (!isKeyPressed(g_keyStates, index)) {
+                animateKeyTo(g_keyStates, index, true, eventTime);
+                postKeyEvent(index, KeyEventType::PRESS, eventTime, !voiced);
+            }
+            noteTypingPress(index, eventTime);
+            if (g_showHeatmap)
+                updateTypingHeat(g_keyStates.heat, index);
+        }
+    }
+    else if (action == GLFW_RELEASE && g_keyHoldCount[index] > 0) {
+        if (--g_keyHoldCount[index] > 0)
+            return;
+        noteTypingRelease(index, eventTime); // the finger is up, whatever else holds the key
+        if (!isKeyHeld(index) && isKeyPressed(g_keyStates, index)) {
+            animateKeyTo(g_keyStates, index, false, eventTime);
+            postKeyEvent(index, KeyEventType::RELEASE, eventTime);
+        }
+    }
+}
+
+// -------------------------
+// GLFW Mouse Button Callback
+// -------------------------
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
+    double eventTime = g_inputClock();
+    double xpos = g_cursorX, ypos = g_cursorY;
+    if (window)
+        glfwGetCursorPos(window, &xpos, &ypos);
+    InputRecord record;
+    record.time = eventTime;
+    record.type = InputRecordType::MOUSE_BUTTON;
+    record.code = button;
+    record.action = static_cast<std::uint8_t>(action);
+    record.mods = static_cast<std::uint16_t>(mods);
+    record.x = xpos;
+    record.y = ypos;
+    recordInput(record);
+    flushCursorDrag(); // the path so far happened before this click
+
+    if (button == GLFW_MOUSE_BUTTON_LEFT) {
+        if (action == GLFW_PRESS) {
+            g_leftMouseDown = true;
+            s_dragLast = { xpos, ypos, eventTime };
+            // Check which key is under the mouse and trigger it
+            g_dragKeyIndex = findKeyAt(g_keyGrid, keyboardKeys, xpos, ypos);
+            // Nothing to do for a key something else holds down already
+            if (g_dragKeyIndex >= 0 && !isKeyPressed(g_keyStates, g_dragKeyIndex)) {
+                animateKeyTo(g_keyStates, g_dragKeyIndex, true, eventTime);
+                postKeyEvent(g_dragKeyIndex, KeyEventType::PRESS, eventTime);
+            }
+        }
+        else if (action == GLFW_RELEASE) {
+            g_leftMouseDown = false;
+            g_dragKeyIndex = -1;
+            // Release every key the mouse left down, unless a key or a
+            // mirrored board still holds it
+            for (int i = 0; i < static_cast<int>(keyboardKeys.size()); i++) {
+                if (!isKeyPressed(g_keyStates, i) || isKeyHeld(i))
+                    continue;
+                animateKeyTo(g_keyStates, i, false, eventTime);
+                postKeyEvent(i, KeyEventType::RELEASE, eventTime);
+            }
+        }
+    }
+    else if (button == GLFW_MOUSE_BUTTON_RIGHT) {
+        if (action == GLFW_PRESS) {
+            // Right click toggles keycap removal for the key under the mouse
+            int index = findKeyAt(g_keyGrid, keyboardKeys, xpos, ypos);
+            if (index >= 0) {
+                g_keyStates.keycapRemoved[index] ^= 1;
+                g_needsRedraw = true;
+            }
+        }
+    }
+}
+
+// -------------------------
+// GLFW Cursor Position Callback (for drag functionality)
+// -------------------------
+// Only queues the sample; flushCursorDrag() walks the path once per pass
+void cursor_position_callback(GLFWwindow* window, double xpos, double ypos) {
+    double eventTime = g_inputClock();
+    InputRecord record;
+    record.time = eventTime;
+    record.type = InputRecordType::CURSOR;
+    record.x = xpos;
+    record.y = ypos;
+    recordInput(record);
+
+    g_cursorX = xpos;
+    g_cursorY = ypos;
+    if (g_leftMouseDown) {
+        if (s_dragSampleCount == DRAG_SAMPLE_CAPACITY)
+            flushCursorDrag();
+        s_dragSamples[s_dragSampleCount++] = { xpos, ypos, eventTime };
+    }
+}
+
+// -------------------------
+// Cursor Drag
+// -------------------------
+static void pressDragKey(int index, double time) {
+    if (index < 0 || isKeyPressed(g_keyStates, index))
+        return;
+    animateKeyTo(g_keyStates, index, true, time);
+    postKeyEvent(index, KeyEventType::PRESS, time);
+}
+
+// The mouse is leaving index, so only the other sources count
+static void releaseDragKey(int index, double time) {
+    if (index < 0 || g_keyHoldCount[index] > 0 || g_mirrorHoldCount[index] > 0 || !isKeyPressed(g_keyStates, index))
+        return;
+    animateKeyTo(g_keyStates, index, false, time);
+    postKeyEvent(index, KeyEventType::RELEASE, time);
+}
+
+// Every key the cursor crossed between two samples goes down when the path
+// enters it and up when it leaves, stamped where along the segment that
+// happened; the key under the end point stays down.
+static void dragAlongSegment(const CursorSample& from, const CursorSample& to) {
+    static KeySegmentHit hits[DRAG_MAX_CROSSED];
+    int count = findKeysAlongSegment(g_keyGrid, keyboardKeys, from.x, from.y, to.x, to.y, hits, DRAG_MAX_CROSSED);
+    auto timeAt = [&](float t) { return from.time + (to.time - from.time) * t; };
+
+    int current = g_dragKeyIndex;
+    float currentExit = 0.0f;
+    for (int h = 0; h < count; h++) {
+        if (hits[h].key == current) {
+            currentExit = hits[h].exit;
+            continue;
+        }
+        releaseDragKey(current, timeAt(std::min(currentExit, hits[h].enter)));
+        pressDragKey(hits[h].key, timeAt(hits[h].enter));
+        current = hits[h].key;
+        currentExit = hits[h].exit;
+    }
+    int endKey = findKeyAt(g_keyGrid, keyboardKeys, to.x, to.y);
+    if (endKey != current) {
+        releaseDragKey(current, timeAt(currentExit));
+        pressDragKey(endKey, to.time);
+    }
+    g_dragKeyIndex = endKey;
+}
+
+void flushCursorDrag() {
+    if (s_dragSampleCount == 0)
+        return;
+    QG_ZONE("flushCursorDrag");
+    s_batchingDrag = true;
+    for (int i = 0; i < s_dragSampleCount; i++) {
+        const CursorSample& sample = s_dragSamples[i];
+        if (sample.x != s_dragLast.x || sample.y != s_dragLast.y)
+            dragAlongSegment(s_dragLast, sample);
+        s_dragLast = sample;
+    }
+    s_dragSampleCount = 0;
+    submitDragBatch();
+    s_batchingDrag = false;
+}
+
+// Contents were lost (expose, restore from minimize): draw again
+void window_refresh_callback(GLFWwindow* window) {
+    g_needsRedraw = true;
+}
+
+void window_focus_callback(GLFWwindow* window, int focused) {
+    setRawInputFocused(focused == GLFW_TRUE);
+}
+
+// -------------------------
+// Mirroring
+// -------------------------
+void mirror_key_callback(int keyIndex, bool pressed) {
+    if (keyIndex < 0 || keyIndex >= static_cast<int>(keyboardKeys.size()))
+        return;
+    double eventTime = g_inputClock();
+    std::uint8_t& holds = g_mirrorHoldCount[keyIndex];
+    s_applyingMirror = true;
+    if (pressed) {
+        if (holds++ == 0 && !isKeyPressed(g_keyStates, keyIndex)) {
+            animateKeyTo(g_keyStates, keyIndex, true, eventTime);
+            postKeyEvent(keyIndex, KeyEventType::PRESS, eventTime);
+        }
+    }
+    else if (holds > 0) {
+        if (--holds == 0 && !isKeyHeld(keyIndex) && isKeyPressed(g_keyStates, keyIndex)) {
+            animateKeyTo(g_keyStates, keyIndex, false, eventTime);
+            postKeyEvent(keyIndex, KeyEventType::RELEASE, eventTime);
+        }
+    }
+    s_applyingMirror = false;
+}
+
+void collectLocalKeyBits(std::uint64_t* held, std::uint64_t* changed, int wordCount) {
+    for (int w = 0; w < wordCount; w++) {
+        held[w] = 0;
+        changed[w] = 0;
+    }
+    int keyCount = static_cast<int>(keyboardKeys.size());
+    if (keyCount > wordCount * 64)
+        keyCount = wordCount * 64;
+    for (int i = 0; i < keyCount; i++) {
+        if (g_keyHoldCount[i] > 0)
+            held[i / 64] |= std::uint64_t(1) << (i % 64);
+    }
+    if (g_leftMouseDown && g_dragKeyIndex >= 0 && g_dragKeyIndex < keyCount)
+        held[g_dragKeyIndex / 64] |= std::uint64_t(1) << (g_dragKeyIndex % 64);
+    for (int w = 0; w < wordCount && w < static_cast<int>(s_localKeyChanged.size()); w++) {
+        changed[w] = s_localKeyChanged[w];
+        s_localKeyChanged[w] = 0;
+    }
+}
+
+// -------------------------
+// Replay
+// -------------------------
+void replayInputRecord(const InputRecord& record) {
+    switch (record.type) {
+    case InputRecordType::KEY:
+        keyCallback(nullptr, record.code, record.scancode, record.action, record.mods);
+        break;
+    case InputRecordType::MOUSE_BUTTON:
+        g_cursorX = record.x;
+        g_cursorY = record.y;
+        mouse_button_callback(nullptr, record.code, record.action, record.mods);
+        break;
+    case InputRecordType::CURSOR:
+        cursor_position_callback(nullptr, record.x, record.y);
+        break;
+    }
+}
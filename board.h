@@ -0,0 +1,119 @@
+// board.h
+// The simulated board: keys built from a layout, their press state, and the
+// GLFW callbacks that drive both. Kept apart from main() so the benchmark
+// harness can feed scripted input through exactly the code a window does.
+//
+// Single-threaded: the callbacks and everything reading this state run on
+// the thread that pumps GLFW events. The render thread and the raw input
+// listener work from copies (render_thread.h, raw_input.h).
+
+#pragma once
+
+#include "input_log.h"
+#include "key_hit_grid.h"
+#include "key_state.h"
+#include "keyboard.h"
+#include "layout.h"
+
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+constexpr double PRESS_FEEDBACK_DURATION = 0.15; // seconds for press animation
+
+// -------------------------
+// Board State
+// -------------------------
+extern std::vector<Key> keyboardKeys;
+extern KeyStates g_keyStates; // press state of keyboardKeys[i]
+// GLFW key code -> index into keyboardKeys. Several codes may map to the same
+// key; it stays down while any of them is held.
+constexpr std::int16_t UNMAPPED_KEY = -1;
+extern std::array<std::int16_t, GLFW_KEY_LAST + 1> glfwKeyToIndex;
+extern std::vector<std::uint8_t> g_keyHoldCount; // physical keys holding each key down
+extern std::vector<std::uint8_t> g_mirrorHoldCount; // mirrored boards holding each key down
+extern KeyHitGrid g_keyGrid;
+
+// Global flag for left mouse button state
+extern bool g_leftMouseDown;
+extern int g_dragKeyIndex; // key currently held down by the mouse, or -1
+extern double g_cursorX, g_cursorY; // last cursor_position_callback position
+
+// Set by callbacks whenever the board changed (press, release, keycap,
+// expose); the main loop clears it when it hands the state to the renderer.
+extern bool g_needsRedraw;
+
+// Input-to-photon: callback times of presses no swapped frame has shown yet.
+// publishBoardState() hands them to the render thread, the one writer of
+// LATENCY_INPUT_TO_PHOTON. Reserved in applyLayout and never grown, so a
+// press never allocates.
+extern std::vector<double> g_pendingPhotons;
+
+// Tint keycaps by how often they were pressed (g_keyStates.heat). Needs
+// typing stats running (typing_stats.h).
+extern bool g_showHeatmap;
+
+// Stamps events at callback entry. glfwGetTime unless a replay substitutes
+// its own timeline.
+using InputClock = double (*)();
+extern InputClock g_inputClock;
+
+// -------------------------
+// Board Setup & Per-frame Work
+// -------------------------
+// Builds keyboardKeys and everything indexed by key from a loaded layout, with
+// the board's top-left at (originX, originY).
+void applyLayout(const Layout& layout, float originX, float originY);
+
+// Board origin in a window of the given size: the layout's reference block
+// centered, then offset.
+glm::vec2 computeBoardOrigin(const LayoutHeader& board, int windowWidth, int windowHeight);
+
+// Where each label starts with its key at rest; the renderer applies the
+// press shift and hides labels of removed keycaps.
+std::vector<glm::vec2> computeLabelAnchors();
+
+// Puts every moving key where its animation has it at time now (the frame
+// being drawn); returns true while any is still moving toward its target
+// (including the frame it arrives). Keys at rest cost nothing.
+bool updateKeyAnimations(KeyStates& states, double now);
+
+// Plays the drag path the cursor samples queued since the last call: every
+// key a segment between two samples crossed is pressed and released, however
+// fast the swipe, and their clicks go to the audio engine in one batch. Call
+// once per event pass, after the callbacks ran.
+void flushCursorDrag();
+
+// -------------------------
+// GLFW Callbacks
+// -------------------------
+// Each callback appends what it received to the input log while recording.
+// window may be nullptr for replayed input; mouse_button_callback then uses
+// the last position cursor_position_callback saw. cursor_position_callback
+// only queues drag samples; see flushCursorDrag().
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
+void cursor_position_callback(GLFWwindow* window, double xpos, double ypos);
+void window_refresh_callback(GLFWwindow* window);
+void window_focus_callback(GLFWwindow* window, int focused); // raw input follows focus
+
+// -------------------------
+// Mirroring
+// -------------------------
+// Presses and releases from other boards (mirror_net.h MirrorKeyHandler). A
+// key stays down while any local or mirrored source holds it; mirrored
+// presses click but are neither logged nor counted in typing stats.
+void mirror_key_callback(int keyIndex, bool pressed);
+
+// Bitmasks over key indices for the mirror sender: keys held locally (by a
+// physical key or the mouse), and keys pressed or released locally since the
+// previous call. Mirrored presses are left out so boards never echo each
+// other. wordCount 64-bit words each; keys past them are dropped.
+void collectLocalKeyBits(std::uint64_t* held, std::uint64_t* changed, int wordCount);
+
+// Feeds a recorded event back through the callback that received it, with
+// the cursor where it was. Point g_inputClock at the replay timeline first so
+// the event is stamped with its recorded time.
+void replayInputRecord(const InputRecord& record);
@@ -0,0 +1,180 @@
+// click_patches.cpp
+// See click_patches.h. The original ChucK lines are kept next to the values
+// they became; ADSR.set() durations are in seconds.
+
+#include "click_patches.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// -------------------------
+// Ultra-Crisp Click (full_board.cpp)
+// -------------------------
+// This version focuses on a very sharp, high-frequency burst to simulate an
+// extremely loud mechanical key click. The parameters are tuned to avoid any low-end muddiness.
+//   Noise clickNoise => HPF noiseHPF => ADSR noiseEnv => dac;
+//   SinOsc clickSine => ADSR sineEnv => dac;
+ClickPatch makeUltraCrispClickPatch() {
+    ClickPatch patch;
+
+    // Noise component: ultra-short burst for the raw click edge
+    patch.noise.gain = 1.0f;
+    patch.noise.freq = 5000.0f;                        // High-pass filter to cut out lower frequencies
+    patch.noise.env = { 0.0f, 1.0f, 0.0003f, 0.02f };  // Blisteringly fast attack and decay
+
+    // Sine component: a piercing transient to accentuate the click
+    patch.sine.gain = 1.0f;
+    patch.sine.freq = 10000.0f;                        // Extremely high frequency for extra snap
+    patch.sine.env = { 0.0f, 1.0f, 0.0001f, 0.015f };  // Even shorter envelope for a razor-thin burst
+
+    // Fire both components simultaneously for maximum impact
+    patch.noise.hold = 0.001f;  // A brief moment for the click to be audible
+    patch.sine.hold = 0.001f;
+    patch.length = 0.011f;      // Allow the tails to decay naturally
+    return patch;
+}
+
+// -------------------------
+// Cherry MX Blue (with numbers and functions.cpp)
+// -------------------------
+//   fun void blueSwitch() { ... }
+ClickPatch makeBlueSwitchPatch() {
+    ClickPatch patch;
+
+    // The click: a very short, high-frequency noise burst.
+    patch.noise.gain = 0.4f;
+    patch.noise.freq = 3000.0f;                          // High-pass to emphasize high frequencies
+    patch.noise.q = 0.5f;
+    patch.noise.env = { 0.0002f, 0.001f, 0.0f, 0.0005f };
+    patch.noise.hold = 0.0012f;                          // (attack + decay) => now
+
+    // The tactile bump: a brief sine tone.
+    patch.sine.gain = 0.2f;
+    patch.sine.freq = 250.0f;
+    patch.sine.env = { 0.0005f, 0.001f, 0.0f, 0.001f };
+    patch.sine.hold = 0.0015f;                           // (bAttack + bDecay) => now
+
+    // Click release, then a very short delay before the tactile bump.
+    patch.sine.onset = patch.noise.hold + patch.noise.env.release + 0.001f;
+    patch.length = patch.sine.onset + patch.sine.hold + patch.sine.env.release;
+    return patch;
+}
+
+// -------------------------
+// MX Green Click (mx_green)
+// -------------------------
+//   fun void clickSound() { Noise n => HPF hpf => ADSR env => dac; ... }
+ClickPatch makeGreenSwitchPatch() {
+    ClickPatch patch;
+    patch.noise.gain = 0.3f;
+    patch.noise.freq = 3000.0f;
+    patch.noise.q = 0.5f;
+    patch.noise.env = { 0.0002f, 0.001f, 0.0f, 0.001f };
+    patch.noise.hold = 0.0012f;                          // (attack + decay) => now
+    patch.length = patch.noise.hold + patch.noise.env.release;
+    return patch;
+}
+
+const ClickPatch* builtinClickPatches() {
+    static const ClickPatch patches[CLICK_PATCH_COUNT] = {
+        makeUltraCrispClickPatch(),
+        makeBlueSwitchPatch(),
+        makeGreenSwitchPatch()
+    };
+    return patches;
+}
+
+static const char* const CLICK_PATCH_NAMES[CLICK_PATCH_COUNT] = {
+    "ultra_crisp",
+    "mx_blue",
+    "mx_green"
+};
+
+const char* clickPatchName(int id) {
+    return id >= 0 && id < CLICK_PATCH_COUNT ? CLICK_PATCH_NAMES[id] : nullptr;
+}
+
+int findClickPatch(const char* name) {
+    for (int i = 0; i < CLICK_PATCH_COUNT; i++) {
+        if (std::strcmp(CLICK_PATCH_NAMES[i], name) == 0)
+            return i;
+    }
+    return -1;
+}
+
+// -------------------------
+// Switch Sound Files
+// -------------------------
+static bool parseLayerField(ClickLayerParams& layer, const std::string& field, std::istringstream& values) {
+    if (field == "gain")
+        return static_cast<bool>(values >> layer.gain);
+    if (field == "freq")
+        return static_cast<bool>(values >> layer.freq);
+    if (field == "q")
+        return static_cast<bool>(values >> layer.q);
+    if (field == "onset")
+        return static_cast<bool>(values >> layer.onset);
+    if (field == "hold")
+        return static_cast<bool>(values >> layer.hold);
+    if (field == "env")
+        return static_cast<bool>(values >> layer.env.attack >> layer.env.decay >> layer.env.sustain >> layer.env.release);
+    return false;
+}
+
+bool parseClickPatch(const std::string& source, ClickPatch& patch, std::string& error) {
+    ClickPatch parsed = patch;
+    std::istringstream in(source);
+    std::string line;
+    for (int lineNumber = 1; std::getline(in, line); lineNumber++) {
+        std::size_t comment = line.find('#');
+        if (comment != std::string::npos)
+            line.erase(comment);
+        std::istringstream words(line);
+        std::string name;
+        if (!(words >> name))
+            continue;
+
+        bool ok = false;
+        std::string field;
+        if (name == "length")
+            ok = static_cast<bool>(words >> parsed.length);
+        else if (name == "noise" && words >> field)
+            ok = parseLayerField(parsed.noise, field, words);
+        else if (name == "sine" && words >> field)
+            ok = parseLayerField(parsed.sine, field, words);
+        std::string extra;
+        if (!ok || words >> extra) {
+            error = std::to_string(lineNumber) + ": cannot parse '" + name + (field.empty() ? "" : " " + field) + "'";
+            return false;
+        }
+    }
+    if (parsed.length <= 0.0f) {
+        error = "0: length must be positive";
+        return false;
+    }
+    patch = parsed;
+    return true;
+}
+
+std::string clickPatchPath(const std::string& directory, int id) {
+    return directory + "/" + clickPatchName(id) + ".patch";
+}
+
+void loadClickPatches(const std::string& directory, ClickPatch* out) {
+    const ClickPatch* builtin = builtinClickPatches();
+    for (int i = 0; i < CLICK_PATCH_COUNT; i++) {
+        out[i] = builtin[i];
+        std::string path = clickPatchPath(directory, i);
+        std::error_code ec;
+        if (!std::filesystem::exists(path, ec))
+            continue;
+        std::ifstream in(path, std::ios::binary);
+        std::string source((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::string error;
+        if (!in || !parseClickPatch(source, out[i], error))
+            std::cerr << "Error: " << path << ":" << (error.empty() ? "0: could not read" : error) << "\n";
+    }
+}
@@ -0,0 +1,55 @@
+// click_patches.h
+// The switch sounds the simulators ship with, expressed as ClickPatch values
+// so audio_engine can pre-render them. Each one started life as the embedded
+// ChucK program of one of the simulators.
+
+#pragma once
+
+#include "audio_engine.h"
+
+#include <string>
+
+enum ClickPatchId {
+    CLICK_ULTRA_CRISP, // full_board.cpp: noise burst + 10 kHz sine snap
+    CLICK_MX_BLUE,     // with numbers and functions.cpp: blueSwitch(), click then tactile bump
+    CLICK_MX_GREEN,    // mx_green: clickSound(), single filtered noise burst
+    CLICK_PATCH_COUNT
+};
+
+ClickPatch makeUltraCrispClickPatch();
+ClickPatch makeBlueSwitchPatch();
+ClickPatch makeGreenSwitchPatch();
+
+// All of the above, indexed by ClickPatchId.
+const ClickPatch* builtinClickPatches();
+
+// Name used in layout files ("ultra_crisp", "mx_blue", "mx_green"), or
+// nullptr for an id out of range.
+const char* clickPatchName(int id);
+
+// ClickPatchId for a layout-file name, or -1.
+int findClickPatch(const char* name);
+
+// -------------------------
+// Switch Sound Files
+// -------------------------
+// Designers tune patches in text files (patches/<name>.patch) that are loaded
+// over the built-in values. A layout picks one with its switch line. Edit a
+// file while the simulator runs and the change is heard on the next press.
+// Format, one parameter per line ('#' starts a comment, times in seconds):
+//   length <t>
+//   noise|sine gain|freq|q|onset|hold <value>
+//   noise|sine env <attack> <decay> <sustain> <release>
+//
+// Applies source over patch, so a file only needs the values it changes.
+// On failure returns false, leaves patch untouched and sets error to
+// "<line>: <message>".
+bool parseClickPatch(const std::string& source, ClickPatch& patch, std::string& error);
+
+// The built-in table with <directory>/<name>.patch applied to every patch
+// that has a file. A missing file keeps the built-in value; a broken one is
+// logged and skipped. out must hold CLICK_PATCH_COUNT patches.
+void loadClickPatches(const std::string& directory, ClickPatch* out);
+
+// Path of the file loadClickPatches() reads for id.
+std::string clickPatchPath(const std::string& directory, int id);
@@ -0,0 +1,243 @@
+// file_watcher.cpp
+// See file_watcher.h.
+
+#include "file_watcher.h"
+
+#include <filesystem>
+#include <iostream>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// -------------------------
+// Helpers
+// -------------------------
+static void splitPath(const std::string& path, std::string& directory, std::string& name) {
+    std::size_t slash = path.find_last_of("/\\");
+    if (slash == std::string::npos) {
+        directory = ".";
+        name = path;
+    }
+    else {
+        directory = slash == 0 ? path.substr(0, 1) : path.substr(0, slash);
+        name = path.substr(slash + 1);
+    }
+}
+
+static std::int64_t fileWriteTime(const std::string& path) {
+    std::error_code ec;
+    auto time = std::filesystem::last_write_time(path, ec);
+    return ec ? 0 : static_cast<std::int64_t>(time.time_since_epoch().count());
+}
+
+static void reportChange(std::vector<int>& changed, int id) {
+    for (int c : changed) {
+        if (c == id)
+            return;
+    }
+    changed.push_back(id);
+}
+
+// Every file in directory d, for when the platform lost track of the details.
+static void reportDirectory(const FileWatcher& watcher, int d, std::vector<int>& changed) {
+    for (int i = 0; i < static_cast<int>(watcher.files.size()); i++) {
+        if (watcher.files[i].directory == d)
+            reportChange(changed, i);
+    }
+}
+
+static void reportName(const FileWatcher& watcher, int d, const std::string& name, std::vector<int>& changed) {
+    for (int i = 0; i < static_cast<int>(watcher.files.size()); i++) {
+        if (watcher.files[i].directory == d && watcher.files[i].name == name)
+            reportChange(changed, i);
+    }
+}
+
+static bool isNotified(const WatchedDirectory& directory) {
+    return directory.watch >= 0 || directory.native != nullptr;
+}
+
+// -------------------------
+// Windows: ReadDirectoryChangesW
+// -------------------------
+#if defined(_WIN32)
+struct DirectoryChanges {
+    HANDLE handle = INVALID_HANDLE_VALUE;
+    OVERLAPPED overlapped = {};
+    DWORD buffer[2048];             // FILE_NOTIFY_INFORMATION records, DWORD aligned
+};
+
+constexpr DWORD DIRECTORY_CHANGE_FILTER =
+    FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+
+static bool requestChanges(DirectoryChanges& changes) {
+    ResetEvent(changes.overlapped.hEvent);
+    return ReadDirectoryChangesW(changes.handle, changes.buffer, sizeof(changes.buffer), FALSE,
+        DIRECTORY_CHANGE_FILTER, nullptr, &changes.overlapped, nullptr) != 0;
+}
+
+static void* openDirectoryChanges(const std::string& path) {
+    HANDLE handle = CreateFileA(path.c_str(), FILE_LIST_DIRECTORY,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+        FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+        return nullptr;
+    DirectoryChanges* changes = new DirectoryChanges();
+    changes->handle = handle;
+    changes->overlapped.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+    if (!changes->overlapped.hEvent || !requestChanges(*changes)) {
+        if (changes->overlapped.hEvent)
+            CloseHandle(changes->overlapped.hEvent);
+        CloseHandle(handle);
+        delete changes;
+        return nullptr;
+    }
+    return changes;
+}
+
+static void closeDirectoryChanges(void* native) {
+    DirectoryChanges* changes = static_cast<DirectoryChanges*>(native);
+    DWORD bytes = 0;
+    CancelIo(changes->handle);
+    GetOverlappedResult(changes->handle, &changes->overlapped, &bytes, TRUE);
+    CloseHandle(changes->overlapped.hEvent);
+    CloseHandle(changes->handle);
+    delete changes;
+}
+
+static void pollDirectoryChanges(const FileWatcher& watcher, int d, std::vector<int>& changed) {
+    DirectoryChanges* changes = static_cast<DirectoryChanges*>(watcher.directories[d].native);
+    DWORD bytes = 0;
+    if (!GetOverlappedResult(changes->handle, &changes->overlapped, &bytes, FALSE))
+        return; // ERROR_IO_INCOMPLETE: nothing happened yet
+
+    if (bytes == 0) {
+        reportDirectory(watcher, d, changed); // buffer overflowed
+    }
+    else {
+        const unsigned char* record = reinterpret_cast<const unsigned char*>(changes->buffer);
+        for (;;) {
+            const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(record);
+            char name[MAX_PATH * 3];
+            int length = WideCharToMultiByte(CP_UTF8, 0, info->FileName,
+                static_cast<int>(info->FileNameLength / sizeof(WCHAR)), name, sizeof(name), nullptr, nullptr);
+            if (length > 0)
+                reportName(watcher, d, std::string(name, static_cast<std::size_t>(length)), changed);
+            if (info->NextEntryOffset == 0)
+                break;
+            record += info->NextEntryOffset;
+        }
+    }
+    if (!requestChanges(*changes))
+        std::cerr << "Warning: Stopped watching " << watcher.directories[d].path << " for changes\n";
+}
+#endif
+
+// -------------------------
+// Public Interface
+// -------------------------
+bool openFileWatcher(FileWatcher& watcher) {
+#if defined(__linux__)
+    watcher.inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watcher.inotifyFd < 0) {
+        std::cerr << "Warning: inotify is unavailable, polling files for changes instead\n";
+        return false;
+    }
+#endif
+    return true;
+}
+
+void closeFileWatcher(FileWatcher& watcher) {
+#if defined(_WIN32)
+    for (auto& d : watcher.directories) {
+        if (d.native)
+            closeDirectoryChanges(d.native);
+        d.native = nullptr;
+    }
+#elif defined(__linux__)
+    if (watcher.inotifyFd >= 0)
+        close(watcher.inotifyFd); // drops every watch with it
+    watcher.inotifyFd = -1;
+#endif
+    watcher.files.clear();
+    watcher.directories.clear();
+}
+
+int watchFile(FileWatcher& watcher, const std::string& path) {
+    WatchedFile file;
+    file.path = path;
+    std::string directory;
+    splitPath(path, directory, file.name);
+    file.lastWriteTime = fileWriteTime(path);
+
+    for (int d = 0; d < static_cast<int>(watcher.directories.size()); d++) {
+        if (watcher.directories[d].path == directory)
+            file.directory = d;
+    }
+    if (file.directory < 0) {
+        WatchedDirectory dir;
+        dir.path = directory;
+#if defined(_WIN32)
+        dir.native = openDirectoryChanges(directory);
+#elif defined(__linux__)
+        if (watcher.inotifyFd >= 0) {
+            // Replacing saves show up as IN_MOVED_TO, in-place ones as IN_CLOSE_WRITE
+            dir.watch = inotify_add_watch(watcher.inotifyFd, directory.c_str(),
+                IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE);
+        }
+#endif
+        if (!isNotified(dir))
+            std::cerr << "Warning: Could not watch " << directory << ", polling it for changes\n";
+        file.directory = static_cast<int>(watcher.directories.size());
+        watcher.directories.push_back(dir);
+    }
+
+    watcher.files.push_back(file);
+    return static_cast<int>(watcher.files.size()) - 1;
+}
+
+void pollFileWatcher(FileWatcher& watcher, std::vector<int>& changed) {
+#if defined(__linux__)
+    if (watcher.inotifyFd >= 0) {
+        alignas(inotify_event) char buffer[4096];
+        for (;;) {
+            ssize_t bytes = read(watcher.inotifyFd, buffer, sizeof(buffer));
+            if (bytes <= 0)
+                break; // EAGAIN: drained
+            for (ssize_t offset = 0; offset < bytes;) {
+                const inotify_event* e = reinterpret_cast<const inotify_event*>(buffer + offset);
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + e->len);
+                for (int d = 0; d < static_cast<int>(watcher.directories.size()); d++) {
+                    if (e->mask & IN_Q_OVERFLOW)
+                        reportDirectory(watcher, d, changed);
+                    else if (watcher.directories[d].watch == e->wd && e->len > 0)
+                        reportName(watcher, d, e->name, changed);
+                }
+            }
+        }
+    }
+#elif defined(_WIN32)
+    for (int d = 0; d < static_cast<int>(watcher.directories.size()); d++) {
+        if (watcher.directories[d].native)
+            pollDirectoryChanges(watcher, d, changed);
+    }
+#endif
+
+    // Fallback for directories without notifications
+    for (int i = 0; i < static_cast<int>(watcher.files.size()); i++) {
+        WatchedFile& file = watcher.files[i];
+        if (isNotified(watcher.directories[file.directory]))
+            continue;
+        std::int64_t time = fileWriteTime(file.path);
+        if (time != file.lastWriteTime) {
+            file.lastWriteTime = time;
+            reportChange(changed, i);
+        }
+    }
+}
@@ -0,0 +1,47 @@
+// file_watcher.h
+// Change notification for the files the simulator loads at startup (layouts,
+// switch sounds), so they can be reloaded while it runs. Uses inotify on
+// Linux and ReadDirectoryChangesW on Windows, and falls back to comparing
+// modification times elsewhere. The containing directory is watched rather
+// than the file itself, because most editors save by writing a new file and
+// renaming it over the old one.
+//
+// Single-threaded: poll from the main loop. Polling never blocks.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct WatchedFile {
+    std::string path;
+    std::string name;               // file name inside the watched directory
+    int directory = -1;             // index into FileWatcher::directories
+    std::int64_t lastWriteTime = 0; // polling fallback only
+};
+
+struct WatchedDirectory {
+    std::string path;
+    int watch = -1;                 // inotify watch descriptor
+    void* native = nullptr;         // Windows: pending ReadDirectoryChangesW request
+};
+
+struct FileWatcher {
+    std::vector<WatchedFile> files;
+    std::vector<WatchedDirectory> directories;
+    int inotifyFd = -1;             // Linux only
+};
+
+// Returns false (after logging) if the platform watcher could not be set up;
+// files are then polled. So is any file whose directory could not be watched.
+bool openFileWatcher(FileWatcher& watcher);
+void closeFileWatcher(FileWatcher& watcher);
+
+// Starts watching path (which does not have to exist yet). Returns the id
+// pollFileWatcher() reports for it.
+int watchFile(FileWatcher& watcher, const std::string& path);
+
+// Appends the id of every watched file that was written, created, replaced or
+// deleted since the last poll; each id at most once per call.
+void pollFileWatcher(FileWatcher& watcher, std::vector<int>& changed);
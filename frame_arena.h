@@ -0,0 +1,59 @@
+// frame_arena.h
+// Linear scratch memory for one frame: allocate() bumps an offset through a
+// block reserved up front and reset() at the start of the next frame drops
+// everything at once. Nothing is freed one by one and nothing is destructed,
+// so only trivially destructible types belong here. Once reserved the arena
+// never touches the heap; a request that does not fit returns nullptr and the
+// caller does less that frame instead of allocating.
+//
+// One owner thread per arena. Pointers are good until the next reset() or
+// reserve().
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+class FrameArena {
+public:
+    // Makes room for at least bytes, counting the padding between
+    // differently aligned allocations, and empties the arena. The one call
+    // that allocates: do it on load, not per frame.
+    void reserve(std::size_t bytes) {
+        reset();
+        if (bytes <= capacityBytes)
+            return;
+        memory.reset(new unsigned char[bytes]);
+        capacityBytes = bytes;
+    }
+
+    void reset() {
+        usedBytes = 0;
+    }
+
+    // count uninitialized Ts, or nullptr when they do not fit
+    template <typename T>
+    T* allocate(std::size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "FrameArena never runs destructors");
+        std::uintptr_t base = reinterpret_cast<std::uintptr_t>(memory.get());
+        std::size_t start = (base + usedBytes + alignof(T) - 1) / alignof(T) * alignof(T) - base;
+        if (start > capacityBytes || count > (capacityBytes - start) / sizeof(T))
+            return nullptr;
+        usedBytes = start + count * sizeof(T);
+        if (usedBytes > highWaterBytes)
+            highWaterBytes = usedBytes;
+        return reinterpret_cast<T*>(memory.get() + start);
+    }
+
+    std::size_t capacity() const { return capacityBytes; }
+    std::size_t used() const { return usedBytes; }
+    std::size_t highWater() const { return highWaterBytes; } // most used in any one frame
+
+private:
+    std::unique_ptr<unsigned char[]> memory;
+    std::size_t capacityBytes = 0;
+    std::size_t usedBytes = 0;
+    std::size_t highWaterBytes = 0;
+};
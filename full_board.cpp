@@ -1,620 +1,443 @@
 // main.cpp
-// Compile on Windows with (example):
-//   cl main.cpp /I"path_to_glm" /I"path_to_stb" /EHsc /link glfw3.lib opengl32.lib user32.lib gdi32.lib
-
-#include <GLFW/glfw3.h>
+// Every simulator variant is a layout file; run with --layout to pick one:
+//   layouts/full_board.layout (default), layouts/numbers_and_functions.layout,
+//   layouts/alphabet_only.layout, layouts/single_key.layout
+// The per-variant executables are this file built with QG_DEFAULT_LAYOUT set
+// to their layout (CMakeLists.txt).
+// Switch sounds load from patches/*.patch (--patches <dir>). The layout and
+// the patch files are watched and reloaded on save while the board runs.
+// --latency shows input-to-photon / input-to-audio percentiles on screen and
+// --latency-csv <file> writes them on exit; both include startup times
+// (window, audio ready, first frame, first click since launch).
+// --record <file> logs every input event; --replay <file> plays a log back
+// with its original timing (live input still works alongside it).
+// --curve linear|ease|spring picks the press animation's shape.
+// --stats <file> keeps per-key press counts, dwell times and inter-key
+// intervals (typing_stats.h); --heatmap tints keys by how often they were hit.
+// Drawing runs on its own thread (render_thread.h); this one handles events.
+// --raw-input plays clicks from the keyboard devices directly (Linux evdev,
+// needs read access to /dev/input), ahead of window events.
+// --mirror-to host[:port] sends this board's presses to other instances over
+// UDP (a broadcast address reaches a whole LAN); --mirror-listen [port] plays
+// the presses of every board sending here (mirror_net.h).
+// --render-scale <0.25..1> draws the board at a fraction of the window's
+// resolution and stretches it; --msaa <n> multisamples it as far as
+// --fb-budget <MB> of offscreen memory allows. Framebuffer memory is
+// reported at startup.
+// Debug builds abort if a main loop pass or a steady render frame allocates
+// (alloc_counter.h); per-frame scratch lives in a FrameArena (frame_arena.h).
+// Build with CMake (see CMakeLists.txt), or on Windows by hand (example):
+//   cl main.cpp alloc_counter.cpp audio_engine.cpp board.cpp click_patches.cpp gl_functions.cpp file_watcher.cpp input_log.cpp keyboard_renderer.cpp label_atlas.cpp key_hit_grid.cpp key_state.cpp latency_stats.cpp layout.cpp mirror_net.cpp raw_input.cpp render_thread.cpp switch_profiles.cpp typing_stats.cpp /I"path_to_glm" /I"path_to_stb" /I"path_to_miniaudio" /EHsc /link glfw3.lib opengl32.lib user32.lib gdi32.lib ws2_32.lib
+
+#include "gl_functions.h"
 #include <glm/glm.hpp>
+#include <cstdint>
 #include <cstdlib>
-#include <fstream>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
-#include <map>
 #include <string>
 #include <vector>
-#include <thread>
-#include "stb_easy_font.h"
+#include "alloc_counter.h"
+#include "audio_engine.h"
+#include "board.h"
+#include "file_watcher.h"
+#include "input_log.h"
+#include "keyboard_renderer.h"
+#include "latency_stats.h"
+#include "layout.h"
+#include "mirror_net.h"
+#include "profiling.h"
+#include "raw_input.h"
+#include "render_thread.h"
+#include "typing_stats.h"
+#include "switch_profiles.h"
 
 // -------------------------
-// Constants & Global Settings (20% increased)
+// Constants & Global Settings
 // -------------------------
-constexpr float KEY_WIDTH = 60.0f;         // originally 50.0f
-constexpr float KEY_HEIGHT = 60.0f;        // originally 50.0f
-constexpr float KEY_SPACING_X = 6.0f;      // originally 5.0f
-constexpr float KEY_SPACING_Y = 6.0f;      // originally 5.0f
-constexpr float KEY_DEPTH = 18.0f;         // originally 15.0f
-constexpr double PRESS_FEEDBACK_DURATION = 0.15; // seconds for press animation
+// Sizes, colors and switch sounds come from the layout file.
+#ifndef QG_DEFAULT_LAYOUT
+#define QG_DEFAULT_LAYOUT "layouts/full_board.layout"
+#endif
+constexpr const char* DEFAULT_LAYOUT_PATH = QG_DEFAULT_LAYOUT;
+constexpr const char* DEFAULT_PATCH_DIR = "patches";
+
+// Threads: this one only pumps events (input callbacks, hot reload, replay)
+// and sleeps in glfwWaitEventsTimeout until input arrives; drawing runs on
+// the render thread (render_thread.h), which only renders while something
+// changes on screen.
+constexpr double IDLE_WAIT_TIMEOUT = 0.5;  // seconds; upper bound on one idle sleep
+constexpr double DEFAULT_FRAME_CAP = 0.0;  // frames per second while animating, 0 = uncapped
+constexpr double RELOAD_RETRY_WAIT = 0.005; // seconds; idle sleep while a patch swap is pending
+constexpr double DEFAULT_FRAMEBUFFER_BUDGET_MB = 128.0; // offscreen board, MSAA included
+
+struct AppOptions {
+    std::string layoutPath = DEFAULT_LAYOUT_PATH; // --layout <file>
+    std::string patchDir = DEFAULT_PATCH_DIR;     // --patches <dir>
+    bool vsync = true;                     // --no-vsync to turn off
+    double frameCap = DEFAULT_FRAME_CAP;   // --fps <n>
+    AnimationCurve curve = AnimationCurve::LINEAR; // --curve linear|ease|spring
+    bool latencyOverlay = false;           // --latency
+    std::string latencyCsvPath;            // --latency-csv <file>, written on exit
+    std::string recordPath;                // --record <file>
+    std::string replayPath;                // --replay <file>
+    bool rawInput = false;                 // --raw-input: clicks straight from evdev
+    std::string statsPath;                 // --stats <file>: typing analytics
+    bool heatmap = false;                  // --heatmap
+    std::string mirrorTarget;              // --mirror-to host[:port]
+    int mirrorListenPort = -1;             // --mirror-listen [port], -1 = off
+    float renderScale = 1.0f;              // --render-scale <s>
+    int msaaSamples = 0;                   // --msaa <n>
+    double framebufferBudgetMB = DEFAULT_FRAMEBUFFER_BUDGET_MB; // --fb-budget <MB>
+};
 
-// Global position for main keyboard block (will be centered)
-float g_mainStartX = 50.0f;
-float g_mainStartY = 50.0f;
+RenderSettings g_renderSettings;
+bool g_rawInput = false; // the raw input listener is running
+
+// Hot reload: the active layout plus a staging slot the next version loads
+// into, so a broken edit never replaces a working board.
+Layout g_layouts[2];
+int g_activeLayout = 0;
+FileWatcher g_watcher;
+int g_layoutWatch = -1;
+int g_patchWatches[SWITCH_PROFILE_COUNT];
+SwitchProfile g_switchProfiles[SWITCH_PROFILE_COUNT];
+ClickPatch g_clickPatches[SWITCH_PROFILE_COUNT]; // sounds of g_switchProfiles, as the audio engine takes them
+bool g_patchReloadPending = false; // audio engine still handing over the last set
+
+// Replay: the log, the next record to dispatch and where the log's timeline
+// sits on glfwGetTime's
+InputLog g_replay;
+std::size_t g_replayNext = 0;
+double g_replayOffset = 0.0;
+double g_replayTime = 0.0;
 
 // -------------------------
-// Embedded ChucK Code (Simple Click)
+// Board Placement
 // -------------------------
-const char* embeddedChucKCode = R"(
-// Ultra-Crisp Mechanical Keyboard Click in ChucK
-//
-// This version focuses on a very sharp, high-frequency burst to simulate an
-// extremely loud mechanical key click. The parameters are tuned to avoid any low-end muddiness.
-
-Noise clickNoise => HPF noiseHPF => ADSR noiseEnv => dac;
-SinOsc clickSine => ADSR sineEnv => dac;
-
-// Noise component: ultra-short burst for the raw click edge
-1.0 => clickNoise.gain;
-5000 => noiseHPF.freq;      // High-pass filter to cut out lower frequencies
-noiseEnv.set(0, 1, 0.0003, 0.02); // Blisteringly fast attack and decay
-
-// Sine component: a piercing transient to accentuate the click
-10000 => clickSine.freq;    // Extremely high frequency for extra snap
-1.0 => clickSine.gain;
-sineEnv.set(0, 1, 0.0001, 0.015);  // Even shorter envelope for a razor-thin burst
-
-// Fire both components simultaneously for maximum impact
-noiseEnv.keyOn();
-sineEnv.keyOn();
-1::ms => now;   // A brief moment for the click to be audible
-noiseEnv.keyOff();
-sineEnv.keyOff();
-10::ms => now;  // Allow the tails to decay naturally
-
-
-)";
-const char* TEMP_CHUCK_FILENAME = "temp_chuck.ck";
+// Places the layout in a window of the given size and rebuilds the meshes.
+void placeBoard(const Layout& layout, int windowWidth, int windowHeight) {
+    const LayoutHeader& board = *layout.header;
+    glm::vec2 origin = computeBoardOrigin(board, windowWidth, windowHeight);
+    applyLayout(layout, origin.x, origin.y);
+    buildKeyboardMesh(keyboardKeys, board.keyDepth, g_switchProfiles, SWITCH_PROFILE_COUNT);
+    buildKeyboardLabels(keyboardKeys, computeLabelAnchors());
+    glClearColor(board.background[0], board.background[1], board.background[2], 1.0f);
+}
 
 // -------------------------
-// Key Types & Colors
+// Hot Reload
 // -------------------------
-enum class KeyType {
-    ALPHANUM,       // Letters, digits, punctuation
-    FUNCTION,       // F-keys and similar
-    MODIFIER,       // Shift, Ctrl, Alt, etc.
-    NAVIGATION,     // Navigation keys (e.g., Ins, Home, PgUp, Del, End, PgDn)
-    ARROW,          // Arrow keys (Up, Down, Left, Right)
-    NUMPAD,         // Numeric keypad (not used now)
-    BACKGROUND_ONLY // For the 'housing'
-};
+// Runs on the main thread with the render thread stopped, so it only ever
+// sees a complete layout. The window keeps its size; everything else follows
+// the file.
+void reloadLayout(GLFWwindow* window, const AppOptions& options) {
+    int staged = 1 - g_activeLayout;
+    if (!loadLayout(options.layoutPath, g_layouts[staged])) {
+        std::cerr << "Warning: Keeping the current layout\n";
+        return;
+    }
+    stopRenderThread(); // it reads the mapped layout through keyboardKeys
+    stopRawInput();
+    stopTypingStats(); // counts are per key of the old layout
+    closeLayout(g_layouts[g_activeLayout]);
+    g_activeLayout = staged;
+
+    const Layout& layout = g_layouts[g_activeLayout];
+    const LayoutHeader& board = *layout.header;
+    glfwSetWindowTitle(window, layoutString(layout, board.titleOffset, board.titleLength).c_str());
+    int windowWidth, windowHeight;
+    glfwGetWindowSize(window, &windowWidth, &windowHeight);
+    glfwMakeContextCurrent(window);
+    placeBoard(layout, windowWidth, windowHeight);
+    glfwMakeContextCurrent(nullptr);
+    g_dragKeyIndex = -1;
+    g_needsRedraw = true;
+    resetMirrorPeers(); // their bits index the old keys
+    if (!options.statsPath.empty() || options.heatmap)
+        startTypingStats(keyboardKeys, options.statsPath);
+    if (!startRenderThread(window, g_renderSettings)) {
+        // Nothing would draw the new board; leave through the normal exit
+        glfwSetWindowShouldClose(window, GLFW_TRUE);
+        return;
+    }
+    if (g_rawInput)
+        startRawInput(window);
+}
 
-static void getBaseColor(KeyType type, float& r, float& g, float& b)
-{
-    switch (type) {
-    case KeyType::FUNCTION:
-        r = 0.8f; g = 0.8f; b = 0.8f;
-        break;
-    case KeyType::MODIFIER:
-        r = 0.85f; g = 0.85f; b = 0.80f;
-        break;
-    case KeyType::NUMPAD:
-        r = 0.90f; g = 0.90f; b = 0.85f;
-        break;
-    case KeyType::ALPHANUM:
-    default:
-        r = 0.93f; g = 0.93f; b = 0.88f;
-        break;
+// Picks up saved layout and patch files. Patches are rendered here and
+// handed to the audio thread, which switches at a buffer boundary.
+void pollHotReload(GLFWwindow* window, const AppOptions& options) {
+    QG_ZONE("pollHotReload");
+    static std::vector<int> changed;
+    changed.clear();
+    pollFileWatcher(g_watcher, changed);
+    bool patchesChanged = false;
+    for (int id : changed) {
+        if (id == g_layoutWatch)
+            reloadLayout(window, options);
+        for (int i = 0; i < SWITCH_PROFILE_COUNT; i++) {
+            if (id == g_patchWatches[i])
+                patchesChanged = true;
+        }
+    }
+    if (patchesChanged) {
+        loadSwitchProfiles(options.patchDir, g_switchProfiles);
+        collectClickPatches(g_switchProfiles, SWITCH_PROFILE_COUNT, g_clickPatches);
+        g_patchReloadPending = true;
     }
+    if (g_patchReloadPending && reloadClickPatches(g_clickPatches, SWITCH_PROFILE_COUNT))
+        g_patchReloadPending = false;
 }
 
 // -------------------------
-// Key Structure
+// Shutdown
 // -------------------------
-struct Key {
-    std::string label;
-    glm::vec2 pos;    // Top-left corner position
-    glm::vec2 size;
-    float pressAnim = 0.0f; // 0.0 (up) to 0.5 (fully pressed)
-    bool isPressed = false;
-    bool keycapRemoved = false; // if true, show advanced mechanical switch design
-    KeyType type;     // For coloring
-};
-
-std::vector<Key> keyboardKeys;
-std::map<int, int> glfwKeyToIndex;
-double g_lastFrameTime = 0.0;
-
-// Global flag for left mouse button state
-bool g_leftMouseDown = false;
+// Stops every thread and device main started, in reverse, and closes the
+// window. Safe with the render thread never started or already stopped.
+void shutdownBoard(GLFWwindow* window, const AppOptions& options) {
+    stopRenderThread();
+    glfwMakeContextCurrent(window);
+    stopInputRecording();
+    closeFileWatcher(g_watcher);
+    stopRawInput();
+    stopTypingStats();
+    closeMirrorReceiver();
+    closeMirrorSender();
+    shutdownAudioEngine();
+    if (!options.latencyCsvPath.empty())
+        writeLatencyCsv(options.latencyCsvPath);
+    shutdownKeyboardRenderer();
+    closeLayout(g_layouts[0]);
+    closeLayout(g_layouts[1]);
+    glfwDestroyWindow(window);
+    glfwTerminate();
+}
 
 // -------------------------
-// Advanced Drawing Functions
+// Replay
 // -------------------------
-void drawBeveledBox3D(float x, float y, float w, float h,
-    float depth,
-    float baseR, float baseG, float baseB)
-{
-    float bevel = depth * 0.5f;
-    // FRONT face
-    glColor3f(baseR, baseG, baseB);
-    glBegin(GL_QUADS);
-    glVertex3f(x, y, 0);
-    glVertex3f(x + w, y, 0);
-    glVertex3f(x + w, y + h, 0);
-    glVertex3f(x, y + h, 0);
-    glEnd();
-
-    // TOP face
-    glColor3f(baseR + 0.07f, baseG + 0.07f, baseB + 0.07f);
-    glBegin(GL_QUADS);
-    glVertex3f(x, y, 0);
-    glVertex3f(x + w, y, 0);
-    glVertex3f(x + w - bevel, y - bevel, -depth);
-    glVertex3f(x - bevel, y - bevel, -depth);
-    glEnd();
-
-    // RIGHT face
-    glColor3f(baseR - 0.05f, baseG - 0.05f, baseB - 0.05f);
-    glBegin(GL_QUADS);
-    glVertex3f(x + w, y, 0);
-    glVertex3f(x + w, y + h, 0);
-    glVertex3f(x + w - bevel, y + h - bevel, -depth);
-    glVertex3f(x + w - bevel, y - bevel, -depth);
-    glEnd();
-
-    // BOTTOM face
-    glColor3f(baseR - 0.02f, baseG - 0.02f, baseB - 0.02f);
-    glBegin(GL_QUADS);
-    glVertex3f(x, y + h, 0);
-    glVertex3f(x + w, y + h, 0);
-    glVertex3f(x + w - bevel, y + h - bevel, -depth);
-    glVertex3f(x - bevel, y + h - bevel, -depth);
-    glEnd();
-
-    // LEFT face
-    glColor3f(baseR - 0.03f, baseG - 0.03f, baseB - 0.03f);
-    glBegin(GL_QUADS);
-    glVertex3f(x, y, 0);
-    glVertex3f(x, y + h, 0);
-    glVertex3f(x - bevel, y + h - bevel, -depth);
-    glVertex3f(x - bevel, y - bevel, -depth);
-    glEnd();
-}
-
-void drawThreeFacedCube(float x, float y, float w, float h,
-    float depth,
-    float baseR, float baseG, float baseB)
-{
-    // FRONT face
-    glColor3f(baseR, baseG, baseB);
-    glBegin(GL_QUADS);
-    glVertex3f(x, y, 0);
-    glVertex3f(x + w, y, 0);
-    glVertex3f(x + w, y + h, 0);
-    glVertex3f(x, y + h, 0);
-    glEnd();
-
-    float bevel = depth * 0.5f;
-    // TOP face
-    glColor3f(baseR + 0.07f, baseG + 0.07f, baseB + 0.07f);
-    glBegin(GL_QUADS);
-    glVertex3f(x, y, 0);
-    glVertex3f(x + w, y, 0);
-    glVertex3f(x + w - bevel, y - bevel, -depth);
-    glVertex3f(x - bevel, y - bevel, -depth);
-    glEnd();
-
-    // LEFT face
-    glColor3f(baseR - 0.03f, baseG - 0.03f, baseB - 0.03f);
-    glBegin(GL_QUADS);
-    glVertex3f(x, y, 0);
-    glVertex3f(x, y + h, 0);
-    glVertex3f(x - bevel, y + h - bevel, -depth);
-    glVertex3f(x - bevel, y - bevel, -depth);
-    glEnd();
-}
-
-void drawKeycap3D(const Key& key) {
-    float pressAnim = key.pressAnim;
-    float bx = key.pos.x, by = key.pos.y;
-    float bw = key.size.x, bh = key.size.y;
-    float shiftLeft = 10.0f * pressAnim;
-    float shiftUp = 10.0f * pressAnim;
-    float pressOffsetZ = KEY_DEPTH * pressAnim;
-    float newDepth = KEY_DEPTH * (1.0f - 0.5f * pressAnim);
-    float x = bx - shiftLeft;
-    float y = by - shiftUp;
-
-    float baseR = 0.9f, baseG = 0.9f, baseB = 0.85f;
-
-    // FRONT face
-    glColor3f(baseR, baseG, baseB);
-    glBegin(GL_QUADS);
-    glVertex3f(x, y, -pressOffsetZ);
-    glVertex3f(x + bw, y, -pressOffsetZ);
-    glVertex3f(x + bw, y + bh, -pressOffsetZ);
-    glVertex3f(x, y + bh, -pressOffsetZ);
-    glEnd();
-
-    // TOP face
-    glColor3f(baseR + 0.07f, baseG + 0.07f, baseB + 0.07f);
-    glBegin(GL_QUADS);
-    glVertex3f(x, y, -pressOffsetZ);
-    glVertex3f(x + bw, y, -pressOffsetZ);
-    glVertex3f(x + bw - newDepth, y - newDepth, -(pressOffsetZ + newDepth));
-    glVertex3f(x - newDepth, y - newDepth, -(pressOffsetZ + newDepth));
-    glEnd();
-
-    // RIGHT face
-    glColor3f(baseR - 0.05f, baseG - 0.05f, baseB - 0.05f);
-    glBegin(GL_QUADS);
-    glVertex3f(x + bw, y, -pressOffsetZ);
-    glVertex3f(x + bw, y + bh, -pressOffsetZ);
-    glVertex3f(x + bw - newDepth, y + bh - newDepth, -(pressOffsetZ + newDepth));
-    glVertex3f(x + bw - newDepth, y - newDepth, -(pressOffsetZ + newDepth));
-    glEnd();
-
-    // BOTTOM face
-    glColor3f(baseR - 0.02f, baseG - 0.02f, baseB - 0.02f);
-    glBegin(GL_QUADS);
-    glVertex3f(x, y + bh, -pressOffsetZ);
-    glVertex3f(x + bw, y + bh, -pressOffsetZ);
-    glVertex3f(x + bw - newDepth, y + bh - newDepth, -(pressOffsetZ + newDepth));
-    glVertex3f(x - newDepth, y + bh - newDepth, -(pressOffsetZ + newDepth));
-    glEnd();
-
-    // LEFT face
-    glColor3f(baseR - 0.03f, baseG - 0.03f, baseB - 0.03f);
-    glBegin(GL_QUADS);
-    glVertex3f(x, y, -pressOffsetZ);
-    glVertex3f(x, y + bh, -pressOffsetZ);
-    glVertex3f(x - newDepth, y + bh - newDepth, -(pressOffsetZ + newDepth));
-    glVertex3f(x - newDepth, y - newDepth, -(pressOffsetZ + newDepth));
-    glEnd();
+double replayClock() {
+    return g_replayTime;
 }
 
-//
-// Show mechanical switch internals when keycapRemoved == true
-//
-void drawMechanicalSwitch3D(const Key& key) {
-    float pressAnim = key.pressAnim;
-    float shiftLeft = 10.0f * pressAnim;
-    float shiftUp = 10.0f * pressAnim;
-    float pressOffsetZ = KEY_DEPTH * pressAnim;
-
-    // Outer "switch housing"
-    float bx = key.pos.x + key.size.x * 0.3f;
-    float by = key.pos.y + key.size.y * 0.3f;
-    float bw = key.size.x * 0.4f;
-    float bh = key.size.y * 0.4f;
-    float outerDepth = 16.0f * (KEY_DEPTH / 15.0f); // scaled accordingly
-    drawBeveledBox3D(bx, by, bw, bh, outerDepth, 0.5f, 0.5f, 0.5f);
-
-    // Inner "stem"
-    float animDepth = outerDepth - 6.0f;
-    {
-        float cloneScale = 0.7f * 0.8f; // 0.56
-        float cloneW = bw * cloneScale;
-        float cloneH = bh * cloneScale;
-        float greenCubeDepth = animDepth * cloneScale * 0.7143f; // ~4.0
-        float normalizedPress = pressAnim / 0.5f;
-        float restingZ = -(greenCubeDepth / 2.0f);
-        float pressedZ = -(greenCubeDepth - 1.0f);
-        float zTranslation = restingZ + normalizedPress * (pressedZ - restingZ);
-
-        float cloneX = bx + (bw - cloneW) / 2.0f + 2.0f;
-        float cloneY = by + (bh - cloneH) / 2.0f + 2.0f;
-
-        glPushMatrix();
-        glTranslatef(-0.5f * shiftLeft, -0.5f * shiftUp, -pressOffsetZ);
-        glTranslatef(0, 0, zTranslation);
-        glPushAttrib(GL_DEPTH_BUFFER_BIT);
-        glDepthFunc(GL_ALWAYS);
-        drawThreeFacedCube(cloneX, cloneY, cloneW, cloneH, greenCubeDepth, 0.1f, 0.4f, 0.1f);
-        glPopAttrib();
-        glPopMatrix();
+// Sends every recorded event that is due through the callbacks, stamped with
+// its recorded time rather than the moment the main loop got to it. Returns
+// seconds until the next one, or -1 once the log is done.
+double dispatchDueReplay() {
+    if (g_replayNext >= g_replay.records.size())
+        return -1.0;
+    double now = glfwGetTime();
+    g_inputClock = replayClock;
+    while (g_replayNext < g_replay.records.size()) {
+        const InputRecord& record = g_replay.records[g_replayNext];
+        double due = record.time + g_replayOffset;
+        if (due > now)
+            break;
+        g_replayTime = due;
+        replayInputRecord(record);
+        g_replayNext++;
     }
+    g_inputClock = glfwGetTime; // live input keeps the real clock
+    if (g_replayNext >= g_replay.records.size())
+        return -1.0;
+    return g_replay.records[g_replayNext].time + g_replayOffset - now;
 }
 
-void drawKeyMerged(const Key& key) {
-    if (key.keycapRemoved)
-        drawMechanicalSwitch3D(key);
-    else
-        drawKeycap3D(key);
-}
-
-void renderText(float x, float y, const char* text) {
-    char buffer[99999];
-    int num_quads = stb_easy_font_print(
-        x,
-        y,
-        const_cast<char*>(text),
-        nullptr,
-        buffer,
-        sizeof(buffer)
-    );
-
-    glDisable(GL_DEPTH_TEST);
-    glColor3f(0.0f, 0.0f, 0.0f);
-    glEnableClientState(GL_VERTEX_ARRAY);
-    glVertexPointer(2, GL_FLOAT, 16, buffer);
-    glDrawArrays(GL_QUADS, 0, num_quads * 4);
-    glDisableClientState(GL_VERTEX_ARRAY);
-    glEnable(GL_DEPTH_TEST);
-}
-
-void updateKeyAnimation(Key& key, float deltaTime) {
-    float animSpeed = 0.5f / static_cast<float>(PRESS_FEEDBACK_DURATION);
-    float target = key.isPressed ? 0.5f : 0.0f;
-    if (key.pressAnim < target) {
-        key.pressAnim += animSpeed * deltaTime;
-        if (key.pressAnim > target) key.pressAnim = target;
-    }
-    else if (key.pressAnim > target) {
-        key.pressAnim -= animSpeed * deltaTime;
-        if (key.pressAnim < target) key.pressAnim = target;
-    }
-}
-
-// Helper to add a key & optionally map a GLFW keycode
-void addKey(const std::string& label, float x, float y, float w, float h, KeyType kt, int glfwKey)
-{
-    Key k;
-    k.label = label;
-    k.pos = glm::vec2(x, y);
-    k.size = glm::vec2(w, h);
-    k.type = kt;
-    keyboardKeys.push_back(k);
-
-    if (glfwKey != -1) {
-        int idx = static_cast<int>(keyboardKeys.size()) - 1;
-        glfwKeyToIndex[glfwKey] = idx;
-    }
+// Caps an event wait so it ends when the next replayed event is due
+double untilReplay(double timeout, double replayDue) {
+    return replayDue >= 0.0 && replayDue < timeout ? replayDue : timeout;
 }
 
 // -------------------------
-// Keyboard Layout
+// Mirroring
 // -------------------------
-void initKeyboardLayout() {
-    keyboardKeys.clear();
-    glfwKeyToIndex.clear();
-
-    // Use the global g_mainStartX, g_mainStartY for the main block's position
-    float startX = g_mainStartX;
-    float startY = g_mainStartY;
-    float currentX = startX;
-    float currentY = startY;
-
-    // Row 1: Esc + F-keys
-    addKey("Esc", currentX, currentY, KEY_WIDTH, KEY_HEIGHT, KeyType::FUNCTION, GLFW_KEY_ESCAPE);
-    currentX += KEY_WIDTH + KEY_SPACING_X;
-    for (int i = 0; i < 12; i++) {
-        std::string label = "F" + std::to_string(i + 1);
-        addKey(label, currentX, currentY, KEY_WIDTH, KEY_HEIGHT, KeyType::FUNCTION, GLFW_KEY_F1 + i);
-        currentX += KEY_WIDTH + KEY_SPACING_X;
-    }
-
-    // Row 2: Number row and Backspace
-    currentX = startX;
-    currentY += KEY_HEIGHT + KEY_SPACING_Y;
-    std::vector<std::pair<std::string, int>> row2 = {
-        {"`", GLFW_KEY_GRAVE_ACCENT},
-        {"1", GLFW_KEY_1}, {"2", GLFW_KEY_2}, {"3", GLFW_KEY_3},
-        {"4", GLFW_KEY_4}, {"5", GLFW_KEY_5}, {"6", GLFW_KEY_6},
-        {"7", GLFW_KEY_7}, {"8", GLFW_KEY_8}, {"9", GLFW_KEY_9},
-        {"0", GLFW_KEY_0}, {"-", GLFW_KEY_MINUS}, {"=", GLFW_KEY_EQUAL}
-    };
-    for (auto& keyPair : row2) {
-        addKey(keyPair.first, currentX, currentY, KEY_WIDTH, KEY_HEIGHT, KeyType::ALPHANUM, keyPair.second);
-        currentX += KEY_WIDTH + KEY_SPACING_X;
-    }
-    addKey("Backspace", currentX, currentY, KEY_WIDTH * 1.5f, KEY_HEIGHT, KeyType::MODIFIER, GLFW_KEY_BACKSPACE);
-
-    // Row 3: QWERTY row
-    currentX = startX;
-    currentY += KEY_HEIGHT + KEY_SPACING_Y;
-    std::vector<std::pair<std::string, int>> row3 = {
-        {"Q", GLFW_KEY_Q}, {"W", GLFW_KEY_W}, {"E", GLFW_KEY_E},
-        {"R", GLFW_KEY_R}, {"T", GLFW_KEY_T}, {"Y", GLFW_KEY_Y},
-        {"U", GLFW_KEY_U}, {"I", GLFW_KEY_I}, {"O", GLFW_KEY_O},
-        {"P", GLFW_KEY_P}, {"[", GLFW_KEY_LEFT_BRACKET}, {"]", GLFW_KEY_RIGHT_BRACKET}
-    };
-    for (auto& keyPair : row3) {
-        addKey(keyPair.first, currentX, currentY, KEY_WIDTH, KEY_HEIGHT, KeyType::ALPHANUM, keyPair.second);
-        currentX += KEY_WIDTH + KEY_SPACING_X;
-    }
-
-    // Row 4: ASDF row
-    currentX = startX;
-    currentY += KEY_HEIGHT + KEY_SPACING_Y;
-    std::vector<std::pair<std::string, int>> row4 = {
-        {"A", GLFW_KEY_A}, {"S", GLFW_KEY_S}, {"D", GLFW_KEY_D},
-        {"F", GLFW_KEY_F}, {"G", GLFW_KEY_G}, {"H", GLFW_KEY_H},
-        {"J", GLFW_KEY_J}, {"K", GLFW_KEY_K}, {"L", GLFW_KEY_L},
-        {";", GLFW_KEY_SEMICOLON}, {"'", GLFW_KEY_APOSTROPHE}
-    };
-    for (auto& keyPair : row4) {
-        addKey(keyPair.first, currentX, currentY, KEY_WIDTH, KEY_HEIGHT, KeyType::ALPHANUM, keyPair.second);
-        currentX += KEY_WIDTH + KEY_SPACING_X;
+// Plays what other boards sent, then sends what this one did this pass:
+// every callback glfwWaitEventsTimeout dispatched goes out as one packet.
+void exchangeMirrorState(const AppOptions& options) {
+    static std::uint64_t held[MIRROR_MAX_WORDS], changed[MIRROR_MAX_WORDS];
+    double now = glfwGetTime();
+    if (options.mirrorListenPort >= 0)
+        dispatchMirrorUpdates(mirror_key_callback, static_cast<int>(keyboardKeys.size()), now);
+    if (!options.mirrorTarget.empty()) {
+        collectLocalKeyBits(held, changed, MIRROR_MAX_WORDS);
+        int words = static_cast<int>((keyboardKeys.size() + 63) / 64);
+        sendMirrorState(held, changed, words < MIRROR_MAX_WORDS ? words : MIRROR_MAX_WORDS, now);
     }
+}
 
-    // Row 5: Shift row (Left Shift, then Z, X, C, V, B, N, M, then Right Shift)
-    currentX = startX;
-    currentY += KEY_HEIGHT + KEY_SPACING_Y;
-    // Left Shift
-    addKey("Shift", currentX, currentY, KEY_WIDTH * 1.5f, KEY_HEIGHT, KeyType::MODIFIER, GLFW_KEY_LEFT_SHIFT);
-    currentX += KEY_WIDTH * 1.5f + KEY_SPACING_X;
-    // Letters Z, X, C, V, B, N, M
-    std::vector<std::pair<std::string, int>> row5 = {
-        {"Z", GLFW_KEY_Z}, {"X", GLFW_KEY_X}, {"C", GLFW_KEY_C},
-        {"V", GLFW_KEY_V}, {"B", GLFW_KEY_B}, {"N", GLFW_KEY_N},
-        {"M", GLFW_KEY_M}
-    };
-    for (auto& keyPair : row5) {
-        addKey(keyPair.first, currentX, currentY, KEY_WIDTH, KEY_HEIGHT, KeyType::ALPHANUM, keyPair.second);
-        currentX += KEY_WIDTH + KEY_SPACING_X;
-    }
-    // Right Shift
-    addKey("Shift", currentX, currentY, KEY_WIDTH * 1.5f, KEY_HEIGHT, KeyType::MODIFIER, GLFW_KEY_RIGHT_SHIFT);
-
-    // Row 6: Bottom row: Ctrl, Alt, Space, Alt, Ctrl
-    float bottomRowY = currentY + KEY_HEIGHT + KEY_SPACING_Y;
-    currentX = startX;
-    addKey("Ctrl", currentX, bottomRowY, KEY_WIDTH * 1.2f, KEY_HEIGHT, KeyType::MODIFIER, GLFW_KEY_LEFT_CONTROL);
-    currentX += KEY_WIDTH * 1.2f + KEY_SPACING_X;
-    addKey("Alt", currentX, bottomRowY, KEY_WIDTH, KEY_HEIGHT, KeyType::MODIFIER, GLFW_KEY_LEFT_ALT);
-    currentX += KEY_WIDTH + KEY_SPACING_X;
-    addKey("Space", currentX, bottomRowY, KEY_WIDTH * 6.0f, KEY_HEIGHT, KeyType::ALPHANUM, GLFW_KEY_SPACE);
-    currentX += KEY_WIDTH * 6.0f + KEY_SPACING_X;
-    addKey("Alt", currentX, bottomRowY, KEY_WIDTH, KEY_HEIGHT, KeyType::MODIFIER, GLFW_KEY_RIGHT_ALT);
-    currentX += KEY_WIDTH + KEY_SPACING_X;
-    addKey("Ctrl", currentX, bottomRowY, KEY_WIDTH * 1.2f, KEY_HEIGHT, KeyType::MODIFIER, GLFW_KEY_RIGHT_CONTROL);
-
-    // -----------------------------
-    // Arrow Keys
-    // -----------------------------
-    // Place arrow keys in an inverted T shape to the right of the main block.
-    float arrowBlockX = g_mainStartX + 948.0f + KEY_SPACING_X * 10; // gap after main block (Row 2 width is 948)
-    float arrowRowY = bottomRowY; // align with bottom row
-    float arrowUpY = arrowRowY - (KEY_HEIGHT + KEY_SPACING_Y);
-    // Arrow keys: Left, Down, Right and Up above Down
-    addKey("Left", arrowBlockX, arrowRowY, KEY_WIDTH, KEY_HEIGHT, KeyType::ARROW, GLFW_KEY_LEFT);
-    addKey("Down", arrowBlockX + (KEY_WIDTH + KEY_SPACING_X), arrowRowY, KEY_WIDTH, KEY_HEIGHT, KeyType::ARROW, GLFW_KEY_DOWN);
-    addKey("Right", arrowBlockX + 2 * (KEY_WIDTH + KEY_SPACING_X), arrowRowY, KEY_WIDTH, KEY_HEIGHT, KeyType::ARROW, GLFW_KEY_RIGHT);
-    addKey("Up", arrowBlockX + (KEY_WIDTH + KEY_SPACING_X), arrowUpY, KEY_WIDTH, KEY_HEIGHT, KeyType::ARROW, GLFW_KEY_UP);
-
-    // -----------------------------
-    // Navigation Keys (Repositioned)
-    // -----------------------------
-    // We want the nav keys to align vertically with the arrow keys (centered on the middle column)
-    // and be moved up one key space to create a gap.
-    // Previously: float navBlockX = arrowBlockX + (KEY_WIDTH + KEY_SPACING_X);
-    // Now, move them left one additional key space:
-    float navBlockX = arrowBlockX;  // moved left one key space
-    float navBlockY2 = arrowUpY - 2 * (KEY_HEIGHT + KEY_SPACING_Y); // bottom nav row (moved up one extra row)
-    float navBlockY1 = navBlockY2 - (KEY_HEIGHT + KEY_SPACING_Y);    // top nav row
-
-    addKey("Ins", navBlockX, navBlockY1, KEY_WIDTH, KEY_HEIGHT, KeyType::NAVIGATION, GLFW_KEY_INSERT);
-    addKey("Home", navBlockX + (KEY_WIDTH + KEY_SPACING_X), navBlockY1, KEY_WIDTH, KEY_HEIGHT, KeyType::NAVIGATION, GLFW_KEY_HOME);
-    addKey("PgUp", navBlockX + 2 * (KEY_WIDTH + KEY_SPACING_X), navBlockY1, KEY_WIDTH, KEY_HEIGHT, KeyType::NAVIGATION, GLFW_KEY_PAGE_UP);
-    addKey("Del", navBlockX, navBlockY2, KEY_WIDTH, KEY_HEIGHT, KeyType::NAVIGATION, GLFW_KEY_DELETE);
-    addKey("End", navBlockX + (KEY_WIDTH + KEY_SPACING_X), navBlockY2, KEY_WIDTH, KEY_HEIGHT, KeyType::NAVIGATION, GLFW_KEY_END);
-    addKey("PgDn", navBlockX + 2 * (KEY_WIDTH + KEY_SPACING_X), navBlockY2, KEY_WIDTH, KEY_HEIGHT, KeyType::NAVIGATION, GLFW_KEY_PAGE_DOWN);
+void wakeMainLoop() {
+    glfwPostEmptyEvent();
 }
 
 // -------------------------
-// GLFW Key Callback
+// Window & Framebuffers
 // -------------------------
-void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
-    if (glfwKeyToIndex.find(key) != glfwKeyToIndex.end()) {
-        int index = glfwKeyToIndex[key];
-        if (action == GLFW_PRESS) {
-            keyboardKeys[index].isPressed = true;
-            std::thread([]() {
-                std::string command = std::string("chuck ") + TEMP_CHUCK_FILENAME;
-                system(command.c_str());
-                }).detach();
-        }
-        else if (action == GLFW_RELEASE) {
-            keyboardKeys[index].isPressed = false;
-        }
-    }
+// With framebuffer objects the board draws into its own target, depth
+// included, so the window only needs color; without them it draws straight
+// to the window and needs a depth buffer there.
+GLFWwindow* createBoardWindow(int width, int height, const std::string& title, GLFWmonitor* monitor,
+    bool windowDepth)
+{
+    glfwWindowHint(GLFW_DEPTH_BITS, windowDepth ? 24 : 0);
+    glfwWindowHint(GLFW_STENCIL_BITS, windowDepth ? 8 : 0);
+    return glfwCreateWindow(width, height, title.c_str(), monitor, nullptr);
 }
 
-// -------------------------
-// GLFW Mouse Button Callback
-// -------------------------
-void mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
-    double xpos, ypos;
-    glfwGetCursorPos(window, &xpos, &ypos);
-
-    if (button == GLFW_MOUSE_BUTTON_LEFT) {
-        if (action == GLFW_PRESS) {
-            g_leftMouseDown = true;
-            // Check which key is under the mouse and trigger it
-            for (auto& k : keyboardKeys) {
-                if (xpos >= k.pos.x && xpos <= k.pos.x + k.size.x &&
-                    ypos >= k.pos.y && ypos <= k.pos.y + k.size.y) {
-                    k.isPressed = true;
-                    std::thread([]() {
-                        std::string command = std::string("chuck ") + TEMP_CHUCK_FILENAME;
-                        system(command.c_str());
-                        }).detach();
-                    break;
-                }
-            }
-        }
-        else if (action == GLFW_RELEASE) {
-            g_leftMouseDown = false;
-            // Release all keys when left button is released
-            for (auto& k : keyboardKeys) {
-                k.isPressed = false;
-            }
-        }
+void reportFramebufferMemory(int framebufferWidth, int framebufferHeight, bool windowDepth) {
+    const double MB = 1024.0 * 1024.0;
+    double pixels = static_cast<double>(framebufferWidth) * framebufferHeight;
+    double windowBytes = pixels * 4 * 2 + (windowDepth ? pixels * 4 : 0); // front + back (+ depth/stencil)
+    KeyboardTargetInfo target = getKeyboardTargetInfo();
+    char line[256];
+    if (target.bytes == 0) {
+        std::snprintf(line, sizeof(line), "Framebuffers: window %dx%d %.1f MB, no offscreen board\n",
+            framebufferWidth, framebufferHeight, windowBytes / MB);
     }
-    else if (button == GLFW_MOUSE_BUTTON_RIGHT) {
-        if (action == GLFW_PRESS) {
-            // Right click toggles keycap removal for the key under the mouse
-            for (auto& k : keyboardKeys) {
-                if (xpos >= k.pos.x && xpos <= k.pos.x + k.size.x &&
-                    ypos >= k.pos.y && ypos <= k.pos.y + k.size.y) {
-                    k.keycapRemoved = !k.keycapRemoved;
-                    break;
-                }
-            }
-        }
+    else {
+        std::string msaa = target.samples ? std::to_string(target.samples) + "x MSAA " : "";
+        std::snprintf(line, sizeof(line),
+            "Framebuffers: window %dx%d %.1f MB, board %dx%d %s%.1f MB, %.1f MB total\n",
+            framebufferWidth, framebufferHeight, windowBytes / MB, target.width, target.height, msaa.c_str(),
+            target.bytes / MB, (windowBytes + target.bytes) / MB);
     }
+    std::cout << line;
 }
 
 // -------------------------
-// GLFW Cursor Position Callback (for drag functionality)
+// Main
 // -------------------------
-void cursor_position_callback(GLFWwindow* window, double xpos, double ypos) {
-    if (g_leftMouseDown) {
-        // When dragging, mark as pressed the key currently under the mouse
-        for (auto& k : keyboardKeys) {
-            if (xpos >= k.pos.x && xpos <= k.pos.x + k.size.x &&
-                ypos >= k.pos.y && ypos <= k.pos.y + k.size.y) {
-                if (!k.isPressed) {
-                    k.isPressed = true;
-                    std::thread([]() {
-                        std::string command = std::string("chuck ") + TEMP_CHUCK_FILENAME;
-                        system(command.c_str());
-                        }).detach();
-                }
-            }
-            else {
-                k.isPressed = false;
-            }
+AppOptions parseOptions(int argc, char** argv) {
+    AppOptions options;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--layout") == 0 && i + 1 < argc)
+            options.layoutPath = argv[++i];
+        else if (std::strcmp(argv[i], "--patches") == 0 && i + 1 < argc)
+            options.patchDir = argv[++i];
+        else if (std::strcmp(argv[i], "--no-vsync") == 0)
+            options.vsync = false;
+        else if (std::strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+            options.frameCap = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--curve") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (std::strcmp(name, "linear") == 0)
+                options.curve = AnimationCurve::LINEAR;
+            else if (std::strcmp(name, "ease") == 0)
+                options.curve = AnimationCurve::EASE_OUT;
+            else if (std::strcmp(name, "spring") == 0)
+                options.curve = AnimationCurve::SPRING;
+            else
+                std::cerr << "Warning: Unknown animation curve " << name << ", using linear\n";
         }
+        else if (std::strcmp(argv[i], "--latency") == 0)
+            options.latencyOverlay = true;
+        else if (std::strcmp(argv[i], "--latency-csv") == 0 && i + 1 < argc)
+            options.latencyCsvPath = argv[++i];
+        else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            options.recordPath = argv[++i];
+        else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+            options.replayPath = argv[++i];
+        else if (std::strcmp(argv[i], "--raw-input") == 0)
+            options.rawInput = true;
+        else if (std::strcmp(argv[i], "--stats") == 0 && i + 1 < argc)
+            options.statsPath = argv[++i];
+        else if (std::strcmp(argv[i], "--heatmap") == 0)
+            options.heatmap = true;
+        else if (std::strcmp(argv[i], "--render-scale") == 0 && i + 1 < argc)
+            options.renderScale = static_cast<float>(std::atof(argv[++i]));
+        else if (std::strcmp(argv[i], "--msaa") == 0 && i + 1 < argc)
+            options.msaaSamples = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--fb-budget") == 0 && i + 1 < argc)
+            options.framebufferBudgetMB = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--mirror-to") == 0 && i + 1 < argc)
+            options.mirrorTarget = argv[++i];
+        else if (std::strcmp(argv[i], "--mirror-listen") == 0) {
+            options.mirrorListenPort = DEFAULT_MIRROR_PORT;
+            if (i + 1 < argc && argv[i + 1][0] >= '0' && argv[i + 1][0] <= '9')
+                options.mirrorListenPort = std::atoi(argv[++i]);
+        }
+        else
+            std::cerr << "Warning: Ignoring unknown option " << argv[i] << "\n";
     }
+    return options;
 }
 
-// -------------------------
-// Write Embedded ChucK Code to a Temporary File
-// -------------------------
-void initChucK() {
-    std::ofstream out(TEMP_CHUCK_FILENAME);
-    if (!out) {
-        std::cerr << "Error: Could not create temporary ChucK file.\n";
-        return;
-    }
-    out << embeddedChucKCode;
-    out.close();
-}
+int main(int argc, char** argv) {
+    AppOptions options = parseOptions(argc, argv);
+    g_keyStates.curve = options.curve;
+    g_showHeatmap = options.heatmap;
+    if (!loadLayout(options.layoutPath, g_layouts[g_activeLayout]))
+        return -1;
+    if (!options.replayPath.empty() && !loadInputLog(options.replayPath, g_replay))
+        return -1;
+    const Layout& layout = g_layouts[g_activeLayout];
+    const LayoutHeader& board = *layout.header;
 
-// -------------------------
-// Main
-// -------------------------
-int main() {
     if (!glfwInit()) {
         std::cerr << "Error: Failed to initialize GLFW\n";
         return -1;
     }
 
-    // Create a fullscreen window on the primary monitor
-    GLFWmonitor* primary = glfwGetPrimaryMonitor();
-    const GLFWvidmode* mode = glfwGetVideoMode(primary);
-    int windowWidth = mode->width;
-    int windowHeight = mode->height;
-    GLFWwindow* window = glfwCreateWindow(windowWidth, windowHeight, "Advanced 3D Keyboard Simulator", primary, nullptr);
+    // Clicks render in memory while the window and GL come up; the first
+    // press finds them ready. Switch profiles first: they pick the patches.
+    loadSwitchProfiles(options.patchDir, g_switchProfiles);
+    collectClickPatches(g_switchProfiles, SWITCH_PROFILE_COUNT, g_clickPatches);
+    beginAudioEngineInit(g_clickPatches, SWITCH_PROFILE_COUNT, glfwGetTime);
+
+    // Fullscreen on the primary monitor unless the layout asks for a window size
+    GLFWmonitor* primary = nullptr;
+    int windowWidth = board.windowWidth;
+    int windowHeight = board.windowHeight;
+    if (windowWidth <= 0 || windowHeight <= 0) {
+        primary = glfwGetPrimaryMonitor();
+        const GLFWvidmode* mode = glfwGetVideoMode(primary);
+        windowWidth = mode->width;
+        windowHeight = mode->height;
+    }
+    std::string title = layoutString(layout, board.titleOffset, board.titleLength);
+    bool windowDepth = false;
+    GLFWwindow* window = createBoardWindow(windowWidth, windowHeight, title, primary, windowDepth);
     if (!window) {
         std::cerr << "Error: Failed to create GLFW window\n";
+        finishAudioEngineInit();
+        shutdownAudioEngine();
         glfwTerminate();
         return -1;
     }
     glfwMakeContextCurrent(window);
+    bool glLoaded = loadGLFunctions();
+    if (glLoaded && !hasFramebufferObjects()) {
+        // Nothing offscreen to hold the depth buffer: start over with one
+        glfwDestroyWindow(window);
+        windowDepth = true;
+        window = createBoardWindow(windowWidth, windowHeight, title, primary, windowDepth);
+        if (!window) {
+            std::cerr << "Error: Failed to create GLFW window\n";
+            finishAudioEngineInit();
+            shutdownAudioEngine();
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+        glLoaded = loadGLFunctions();
+    }
+    if (!glLoaded || !initKeyboardRenderer()) {
+        std::cerr << "Error: OpenGL 3.3 (or 2.1 with ARB_instanced_arrays) is required\n";
+        finishAudioEngineInit();
+        shutdownAudioEngine();
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return -1;
+    }
+    markStartupMilestone(STARTUP_WINDOW);
 
     // Set up callbacks for keyboard and mouse
     glfwSetKeyCallback(window, keyCallback);
     glfwSetMouseButtonCallback(window, mouse_button_callback);
     glfwSetCursorPosCallback(window, cursor_position_callback);
+    glfwSetWindowRefreshCallback(window, window_refresh_callback);
+    glfwSetWindowFocusCallback(window, window_focus_callback);
 
     // Set up orthographic projection based on window dimensions
     glMatrixMode(GL_PROJECTION);
@@ -623,46 +446,79 @@ int main() {
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
 
-    // Calculate main keyboard block dimensions and position (centered)
-    float mainBlockWidth = 948.0f; // based on widest row (Row 2)
-    float mainBlockHeight = 6 * KEY_HEIGHT + 5 * KEY_SPACING_Y; // 6 rows total
-    g_mainStartX = (windowWidth - mainBlockWidth) / 2.0f;
-    g_mainStartY = (windowHeight - mainBlockHeight) / 2.0f;
-
-    initKeyboardLayout();
-    g_lastFrameTime = glfwGetTime();
-    initChucK();
+    // The mesh takes its stem colors and shapes from the switch profiles
+    placeBoard(layout, windowWidth, windowHeight);
+
+    // Cache the board offscreen so a frame only redraws the keys that moved
+    int framebufferWidth, framebufferHeight;
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    KeyboardTargetSettings target;
+    target.renderScale = options.renderScale;
+    target.samples = options.msaaSamples;
+    target.memoryBudget = static_cast<std::size_t>(options.framebufferBudgetMB * 1024.0 * 1024.0);
+    setKeyboardTarget(framebufferWidth, framebufferHeight,
+        static_cast<float>(framebufferWidth) / static_cast<float>(windowWidth), target);
+    if (options.msaaSamples > 1 && getKeyboardTargetInfo().samples < options.msaaSamples)
+        std::cerr << "Warning: MSAA reduced to " << getKeyboardTargetInfo().samples
+                  << "x (framebuffer budget or driver limit)\n";
+    reportFramebufferMemory(framebufferWidth, framebufferHeight, windowDepth);
+
+    finishAudioEngineInit(); // before anything can submit a click
+    if (options.rawInput)
+        g_rawInput = startRawInput(window);
+    if (!options.statsPath.empty() || options.heatmap)
+        startTypingStats(keyboardKeys, options.statsPath);
+    if (!options.mirrorTarget.empty() && !openMirrorSender(options.mirrorTarget))
+        options.mirrorTarget.clear();
+    if (options.mirrorListenPort >= 0
+        && !openMirrorReceiver(static_cast<std::uint16_t>(options.mirrorListenPort), wakeMainLoop))
+        options.mirrorListenPort = -1;
+
+    openFileWatcher(g_watcher);
+    g_layoutWatch = watchFile(g_watcher, options.layoutPath);
+    for (int i = 0; i < SWITCH_PROFILE_COUNT; i++)
+        g_patchWatches[i] = watchFile(g_watcher, clickPatchPath(options.patchDir, i));
+
+    if (!options.recordPath.empty())
+        startInputRecording(options.recordPath, glfwGetTime(), windowWidth, windowHeight);
+    // The log's first moment is now; events keep their spacing from there
+    g_replayOffset = glfwGetTime() - g_replay.startTime;
+
+    float backgroundLuma = 0.3f * board.background[0] + 0.59f * board.background[1] + 0.11f * board.background[2];
+    g_renderSettings.vsync = options.vsync;
+    g_renderSettings.minFrameTime = options.frameCap > 0.0 ? 1.0 / options.frameCap : 0.0;
+    g_renderSettings.latencyOverlay = options.latencyOverlay;
+    g_renderSettings.overlayColor = backgroundLuma > 0.5f ? glm::vec3(0.0f) : glm::vec3(1.0f);
+
+    // The render thread takes the context from here on
+    glfwMakeContextCurrent(nullptr);
+    if (!startRenderThread(window, g_renderSettings)) {
+        shutdownBoard(window, options);
+        return -1;
+    }
 
     while (!glfwWindowShouldClose(window)) {
-        double currentTime = glfwGetTime();
-        float deltaTime = static_cast<float>(currentTime - g_lastFrameTime);
-        g_lastFrameTime = currentTime;
-
-        // Background color: teal
-        glClearColor(0.0f, 0.5f, 0.5f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        glEnable(GL_DEPTH_TEST);
-
-        // Update & draw all keys
-        for (auto& k : keyboardKeys) {
-            updateKeyAnimation(k, deltaTime);
-            drawKeyMerged(k);
-            if (!k.keycapRemoved) {
-                float shiftLeft = 10.0f * k.pressAnim;
-                float shiftUp = 10.0f * k.pressAnim;
-                float labelX = k.pos.x + (k.size.x * 0.5f) - 8.0f - shiftLeft;
-                if (k.label == "Backspace")
-                    labelX -= 10.0f; // Extra left shift for Backspace label
-                float labelY = k.pos.y + (k.size.y * 0.5f) - 8.0f - shiftUp;
-                renderText(labelX, labelY, k.label.c_str());
-            }
+        // Reloading loads files and rebuilds the board; everything else in a
+        // pass, input callbacks included, must not touch the heap
+        pollHotReload(window, options);
+        std::uint64_t passAllocations = threadAllocationCount();
+
+        double replayDue = dispatchDueReplay();
+        flushCursorDrag(); // every cursor sample this pass, live and replayed
+        exchangeMirrorState(options);
+
+        if (g_needsRedraw) {
+            g_needsRedraw = false;
+            publishBoardState();
         }
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        // Sleep until input; drawing and animation go on without us. Saved
+        // files are picked up on the next wake-up.
+        double timeout = g_patchReloadPending ? RELOAD_RETRY_WAIT : IDLE_WAIT_TIMEOUT;
+        glfwWaitEventsTimeout(untilReplay(timeout, replayDue));
+        checkNoAllocations(passAllocations, "a main loop pass");
     }
 
-    glfwDestroyWindow(window);
-    glfwTerminate();
+    shutdownBoard(window, options);
     return 0;
 }
@@ -0,0 +1,88 @@
+// gl_functions.cpp
+// See gl_functions.h.
+
+#include "gl_functions.h"
+
+#include <iostream>
+
+#define QG_DEFINE_GL_FUNCTION(type, name) type qg_##name = nullptr;
+QG_GL_FUNCTIONS(QG_DEFINE_GL_FUNCTION)
+QG_GL_FRAMEBUFFER_FUNCTIONS(QG_DEFINE_GL_FUNCTION)
+#undef QG_DEFINE_GL_FUNCTION
+
+static bool g_hasFramebufferObjects = false;
+
+bool loadGLFunctions() {
+#define QG_LOAD_GL_FUNCTION(type, name) \
+    qg_##name = reinterpret_cast<type>(glfwGetProcAddress(#name)); \
+    if (!qg_##name) \
+        qg_##name = reinterpret_cast<type>(glfwGetProcAddress(#name "ARB")); \
+    if (!qg_##name) { \
+        std::cerr << "Error: OpenGL function " #name " is not available\n"; \
+        return false; \
+    }
+    QG_GL_FUNCTIONS(QG_LOAD_GL_FUNCTION)
+#undef QG_LOAD_GL_FUNCTION
+
+    g_hasFramebufferObjects = true;
+#define QG_LOAD_OPTIONAL_GL_FUNCTION(type, name) \
+    qg_##name = reinterpret_cast<type>(glfwGetProcAddress(#name)); \
+    if (!qg_##name) \
+        g_hasFramebufferObjects = false;
+    QG_GL_FRAMEBUFFER_FUNCTIONS(QG_LOAD_OPTIONAL_GL_FUNCTION)
+#undef QG_LOAD_OPTIONAL_GL_FUNCTION
+    return true;
+}
+
+bool hasFramebufferObjects() {
+    return g_hasFramebufferObjects;
+}
+
+static GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint ok = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        std::cerr << "Error: Shader compilation failed:\n" << log << "\n";
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+GLuint buildShaderProgram(const char* vertexSource, const char* fragmentSource,
+    const char* const* attribNames, int attribCount)
+{
+    GLuint vs = compileShader(GL_VERTEX_SHADER, vertexSource);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+    if (!vs || !fs) {
+        if (vs) glDeleteShader(vs);
+        if (fs) glDeleteShader(fs);
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    for (int i = 0; i < attribCount; i++)
+        glBindAttribLocation(program, static_cast<GLuint>(i), attribNames[i]);
+    glLinkProgram(program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+
+    GLint ok = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        char log[1024];
+        glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+        std::cerr << "Error: Shader link failed:\n" << log << "\n";
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
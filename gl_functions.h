@@ -0,0 +1,115 @@
+// gl_functions.h
+// OpenGL entry points above 1.1, resolved at runtime through glfwGetProcAddress
+// (opengl32.lib only exports 1.1 on Windows). Include this instead of
+// <GLFW/glfw3.h> in files that use buffers or shaders, and call
+// loadGLFunctions() once a context is current.
+
+#pragma once
+
+#define GLFW_INCLUDE_GLEXT
+#include <GLFW/glfw3.h>
+
+#define QG_GL_FUNCTIONS(X) \
+    X(PFNGLGENBUFFERSPROC, glGenBuffers) \
+    X(PFNGLDELETEBUFFERSPROC, glDeleteBuffers) \
+    X(PFNGLBINDBUFFERPROC, glBindBuffer) \
+    X(PFNGLBUFFERDATAPROC, glBufferData) \
+    X(PFNGLBUFFERSUBDATAPROC, glBufferSubData) \
+    X(PFNGLCREATESHADERPROC, glCreateShader) \
+    X(PFNGLDELETESHADERPROC, glDeleteShader) \
+    X(PFNGLSHADERSOURCEPROC, glShaderSource) \
+    X(PFNGLCOMPILESHADERPROC, glCompileShader) \
+    X(PFNGLGETSHADERIVPROC, glGetShaderiv) \
+    X(PFNGLGETSHADERINFOLOGPROC, glGetShaderInfoLog) \
+    X(PFNGLCREATEPROGRAMPROC, glCreateProgram) \
+    X(PFNGLDELETEPROGRAMPROC, glDeleteProgram) \
+    X(PFNGLATTACHSHADERPROC, glAttachShader) \
+    X(PFNGLBINDATTRIBLOCATIONPROC, glBindAttribLocation) \
+    X(PFNGLLINKPROGRAMPROC, glLinkProgram) \
+    X(PFNGLGETPROGRAMIVPROC, glGetProgramiv) \
+    X(PFNGLGETPROGRAMINFOLOGPROC, glGetProgramInfoLog) \
+    X(PFNGLUSEPROGRAMPROC, glUseProgram) \
+    X(PFNGLGETUNIFORMLOCATIONPROC, glGetUniformLocation) \
+    X(PFNGLUNIFORM1FPROC, glUniform1f) \
+    X(PFNGLUNIFORM1IPROC, glUniform1i) \
+    X(PFNGLUNIFORM3FPROC, glUniform3f) \
+    X(PFNGLVERTEXATTRIBPOINTERPROC, glVertexAttribPointer) \
+    X(PFNGLENABLEVERTEXATTRIBARRAYPROC, glEnableVertexAttribArray) \
+    X(PFNGLDISABLEVERTEXATTRIBARRAYPROC, glDisableVertexAttribArray) \
+    X(PFNGLVERTEXATTRIB2FPROC, glVertexAttrib2f) \
+    X(PFNGLVERTEXATTRIBDIVISORPROC, glVertexAttribDivisor) \
+    X(PFNGLDRAWELEMENTSINSTANCEDPROC, glDrawElementsInstanced)
+
+// Framebuffer objects (GL 3.0 / ARB_framebuffer_object). Optional: callers
+// check hasFramebufferObjects() and fall back to drawing straight to the window.
+#define QG_GL_FRAMEBUFFER_FUNCTIONS(X) \
+    X(PFNGLGENFRAMEBUFFERSPROC, glGenFramebuffers) \
+    X(PFNGLDELETEFRAMEBUFFERSPROC, glDeleteFramebuffers) \
+    X(PFNGLBINDFRAMEBUFFERPROC, glBindFramebuffer) \
+    X(PFNGLFRAMEBUFFERRENDERBUFFERPROC, glFramebufferRenderbuffer) \
+    X(PFNGLCHECKFRAMEBUFFERSTATUSPROC, glCheckFramebufferStatus) \
+    X(PFNGLGENRENDERBUFFERSPROC, glGenRenderbuffers) \
+    X(PFNGLDELETERENDERBUFFERSPROC, glDeleteRenderbuffers) \
+    X(PFNGLBINDRENDERBUFFERPROC, glBindRenderbuffer) \
+    X(PFNGLRENDERBUFFERSTORAGEPROC, glRenderbufferStorage) \
+    X(PFNGLRENDERBUFFERSTORAGEMULTISAMPLEPROC, glRenderbufferStorageMultisample) \
+    X(PFNGLBLITFRAMEBUFFERPROC, glBlitFramebuffer)
+
+#define QG_DECLARE_GL_FUNCTION(type, name) extern type qg_##name;
+QG_GL_FUNCTIONS(QG_DECLARE_GL_FUNCTION)
+QG_GL_FRAMEBUFFER_FUNCTIONS(QG_DECLARE_GL_FUNCTION)
+#undef QG_DECLARE_GL_FUNCTION
+
+#define glGenBuffers qg_glGenBuffers
+#define glDeleteBuffers qg_glDeleteBuffers
+#define glBindBuffer qg_glBindBuffer
+#define glBufferData qg_glBufferData
+#define glBufferSubData qg_glBufferSubData
+#define glCreateShader qg_glCreateShader
+#define glDeleteShader qg_glDeleteShader
+#define glShaderSource qg_glShaderSource
+#define glCompileShader qg_glCompileShader
+#define glGetShaderiv qg_glGetShaderiv
+#define glGetShaderInfoLog qg_glGetShaderInfoLog
+#define glCreateProgram qg_glCreateProgram
+#define glDeleteProgram qg_glDeleteProgram
+#define glAttachShader qg_glAttachShader
+#define glBindAttribLocation qg_glBindAttribLocation
+#define glLinkProgram qg_glLinkProgram
+#define glGetProgramiv qg_glGetProgramiv
+#define glGetProgramInfoLog qg_glGetProgramInfoLog
+#define glUseProgram qg_glUseProgram
+#define glGetUniformLocation qg_glGetUniformLocation
+#define glUniform1f qg_glUniform1f
+#define glUniform1i qg_glUniform1i
+#define glUniform3f qg_glUniform3f
+#define glVertexAttribPointer qg_glVertexAttribPointer
+#define glEnableVertexAttribArray qg_glEnableVertexAttribArray
+#define glDisableVertexAttribArray qg_glDisableVertexAttribArray
+#define glVertexAttrib2f qg_glVertexAttrib2f
+#define glVertexAttribDivisor qg_glVertexAttribDivisor
+#define glDrawElementsInstanced qg_glDrawElementsInstanced
+#define glGenFramebuffers qg_glGenFramebuffers
+#define glDeleteFramebuffers qg_glDeleteFramebuffers
+#define glBindFramebuffer qg_glBindFramebuffer
+#define glFramebufferRenderbuffer qg_glFramebufferRenderbuffer
+#define glCheckFramebufferStatus qg_glCheckFramebufferStatus
+#define glGenRenderbuffers qg_glGenRenderbuffers
+#define glDeleteRenderbuffers qg_glDeleteRenderbuffers
+#define glBindRenderbuffer qg_glBindRenderbuffer
+#define glRenderbufferStorage qg_glRenderbufferStorage
+#define glRenderbufferStorageMultisample qg_glRenderbufferStorageMultisample
+#define glBlitFramebuffer qg_glBlitFramebuffer
+
+// Returns false (after logging the first missing entry point) if the current
+// context does not provide everything above. Entry points missing from the
+// core set are also looked up with an ARB suffix (e.g. instancing on GL 2.1).
+bool loadGLFunctions();
+
+// True if loadGLFunctions() also found every framebuffer object entry point.
+bool hasFramebufferObjects();
+
+// Compiles and links a vertex/fragment pair. Attribute names are bound to
+// locations 0..attribCount-1 in order. Returns 0 (after logging) on failure.
+GLuint buildShaderProgram(const char* vertexSource, const char* fragmentSource,
+    const char* const* attribNames, int attribCount);
@@ -0,0 +1,140 @@
+// input_log.cpp
+// See input_log.h.
+
+#include "input_log.h"
+#include "spsc_queue.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// -------------------------
+// Recorder State
+// -------------------------
+// 4096 records cover several seconds of 1000 Hz cursor input, far longer
+// than the writer ever sleeps.
+constexpr std::size_t INPUT_RING_CAPACITY = 4096;
+constexpr std::size_t WRITE_BATCH = 256;       // records per fwrite
+constexpr int WRITER_SLEEP_MS = 10;            // writer poll interval while the ring is empty
+
+static SpscQueue<InputRecord, INPUT_RING_CAPACITY> g_inputRing;
+static std::FILE* g_logFile = nullptr;
+static std::thread g_writerThread;
+static std::atomic<bool> g_writerRunning{ false };
+static bool g_recording = false;               // producer side only
+static std::atomic<std::uint32_t> g_droppedRecords{ 0 };
+static std::string g_logPath;
+
+// -------------------------
+// Writer Thread
+// -------------------------
+// Returns the number of records written.
+static std::size_t drainRing() {
+    InputRecord batch[WRITE_BATCH];
+    std::size_t total = 0;
+    for (;;) {
+        std::size_t count = 0;
+        while (count < WRITE_BATCH && g_inputRing.pop(batch[count]))
+            count++;
+        if (count == 0)
+            break;
+        if (std::fwrite(batch, sizeof(InputRecord), count, g_logFile) != count)
+            std::cerr << "Warning: Failed to write to input log " << g_logPath << "\n";
+        total += count;
+    }
+    return total;
+}
+
+static void writerLoop() {
+    while (g_writerRunning.load(std::memory_order_acquire)) {
+        // Flush after every batch so a crash loses at most one interval
+        if (drainRing() > 0)
+            std::fflush(g_logFile);
+        std::this_thread::sleep_for(std::chrono::milliseconds(WRITER_SLEEP_MS));
+    }
+    drainRing(); // whatever arrived before stop
+}
+
+// -------------------------
+// Public Interface
+// -------------------------
+bool startInputRecording(const std::string& path, double startTime, int windowWidth, int windowHeight) {
+    if (g_recording)
+        stopInputRecording();
+
+    g_logFile = std::fopen(path.c_str(), "wb");
+    if (!g_logFile) {
+        std::cerr << "Error: Failed to create input log " << path << "\n";
+        return false;
+    }
+    InputLogHeader header = {};
+    std::memcpy(header.magic, "QGIL", 4);
+    header.version = INPUT_LOG_VERSION;
+    header.recordSize = sizeof(InputRecord);
+    header.windowWidth = windowWidth;
+    header.windowHeight = windowHeight;
+    header.startTime = startTime;
+    if (std::fwrite(&header, sizeof(header), 1, g_logFile) != 1) {
+        std::cerr << "Error: Failed to write input log " << path << "\n";
+        std::fclose(g_logFile);
+        g_logFile = nullptr;
+        return false;
+    }
+
+    g_logPath = path;
+    g_droppedRecords.store(0, std::memory_order_relaxed);
+    g_writerRunning.store(true, std::memory_order_release);
+    g_writerThread = std::thread(writerLoop);
+    g_recording = true;
+    return true;
+}
+
+void stopInputRecording() {
+    if (!g_recording)
+        return;
+    g_recording = false;
+    g_writerRunning.store(false, std::memory_order_release);
+    g_writerThread.join();
+    std::fclose(g_logFile);
+    g_logFile = nullptr;
+
+    std::uint32_t dropped = g_droppedRecords.load(std::memory_order_relaxed);
+    if (dropped > 0)
+        std::cerr << "Warning: Input log " << g_logPath << " is missing " << dropped
+                  << " events (writer fell behind)\n";
+}
+
+void recordInput(const InputRecord& record) {
+    if (g_recording && !g_inputRing.push(record))
+        g_droppedRecords.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool loadInputLog(const std::string& path, InputLog& log) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        std::cerr << "Error: Failed to open input log " << path << "\n";
+        return false;
+    }
+    InputLogHeader header;
+    if (std::fread(&header, sizeof(header), 1, file) != 1 || std::memcmp(header.magic, "QGIL", 4) != 0 ||
+        header.version != INPUT_LOG_VERSION || header.recordSize != sizeof(InputRecord))
+    {
+        std::cerr << "Error: " << path << " is not a version " << INPUT_LOG_VERSION << " input log\n";
+        std::fclose(file);
+        return false;
+    }
+
+    log.startTime = header.startTime;
+    log.windowWidth = header.windowWidth;
+    log.windowHeight = header.windowHeight;
+    log.records.clear();
+    InputRecord batch[WRITE_BATCH];
+    std::size_t count;
+    while ((count = std::fread(batch, sizeof(InputRecord), WRITE_BATCH, file)) > 0)
+        log.records.insert(log.records.end(), batch, batch + count);
+    std::fclose(file);
+    return true;
+}
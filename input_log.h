@@ -0,0 +1,70 @@
+// input_log.h
+// Recording and replay of real input sessions. Every key, mouse button and
+// cursor event the GLFW callbacks receive is appended to a binary log with
+// its callback timestamp; replaying the log feeds the same events back
+// through the callbacks at the same times, so a slowdown seen on someone's
+// machine can be reproduced and profiled offline (see bench_workloads).
+//
+// File: InputLogHeader, then InputRecords until the end of the file. The log
+// is append-only; a record cut short by a crash is ignored on load.
+//
+// recordInput() runs on the thread that pumps GLFW events. It copies the
+// record into a ring buffer and returns; a background thread writes the ring
+// to disk, so recording never waits on file I/O.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+constexpr std::uint32_t INPUT_LOG_VERSION = 1;
+
+enum class InputRecordType : std::uint8_t {
+    KEY,
+    MOUSE_BUTTON,
+    CURSOR
+};
+
+struct InputLogHeader {
+    char magic[4];                  // "QGIL"
+    std::uint32_t version;          // INPUT_LOG_VERSION
+    std::uint32_t recordSize;       // sizeof(InputRecord)
+    std::int32_t windowWidth;       // cursor positions are in this window's
+    std::int32_t windowHeight;      // coordinates; replay places the board to match
+    std::uint32_t reserved;
+    double startTime;               // input clock when recording started
+};
+
+struct InputRecord {
+    double time = 0.0;              // input clock at callback entry
+    double x = 0.0, y = 0.0;        // cursor position (MOUSE_BUTTON, CURSOR)
+    std::int32_t code = 0;          // GLFW key or mouse button
+    std::int32_t scancode = 0;
+    InputRecordType type = InputRecordType::KEY;
+    std::uint8_t action = 0;        // GLFW_PRESS / GLFW_RELEASE / GLFW_REPEAT
+    std::uint16_t mods = 0;
+    std::uint32_t reserved = 0;
+};
+
+static_assert(sizeof(InputRecord) == 40, "InputRecord is written to disk as is");
+
+struct InputLog {
+    double startTime = 0.0;
+    int windowWidth = 0, windowHeight = 0;
+    std::vector<InputRecord> records; // in time order
+};
+
+// Creates (truncates) path and starts the writer thread. Returns false after
+// logging an error; recordInput() is then a no-op.
+bool startInputRecording(const std::string& path, double startTime, int windowWidth, int windowHeight);
+
+// Flushes everything recorded so far, stops the writer thread and closes the
+// file. Warns if the ring overflowed and records were lost.
+void stopInputRecording();
+
+// Producer side; wait-free and allocation-free. Does nothing unless recording.
+void recordInput(const InputRecord& record);
+
+// Returns false after logging an error if path is not a readable input log.
+bool loadInputLog(const std::string& path, InputLog& log);
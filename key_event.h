@@ -0,0 +1,19 @@
+// key_event.h
+// Press/release record handed from the input callbacks to the audio thread.
+
+#pragma once
+
+#include <cstdint>
+
+enum class KeyEventType : std::uint8_t {
+    PRESS,
+    RELEASE
+};
+
+struct KeyEvent {
+    double time = 0.0;            // glfwGetTime() at callback entry
+    std::int32_t keyIndex = -1;   // index into keyboardKeys
+    float velocity = 1.0f;        // 0..1, scales the click gain
+    std::uint16_t patchIndex = 0; // which pre-rendered click to play
+    KeyEventType type = KeyEventType::PRESS;
+};
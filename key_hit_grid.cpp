@@ -0,0 +1,157 @@
+// key_hit_grid.cpp
+// See key_hit_grid.h. The cells are stored compressed (offsets + one flat
+// index array) so a query touches two small contiguous ranges.
+
+#include "key_hit_grid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static int clampCell(int value, int count) {
+    return std::min(std::max(value, 0), count - 1);
+}
+
+void buildKeyHitGrid(KeyHitGrid& grid, const std::vector<Key>& keys, float cellSize) {
+    grid = KeyHitGrid();
+    grid.cellSize = cellSize;
+    if (keys.empty() || cellSize <= 0.0f)
+        return;
+
+    float minX = keys[0].pos.x, minY = keys[0].pos.y;
+    float maxX = minX, maxY = minY;
+    for (const auto& k : keys) {
+        minX = std::min(minX, k.pos.x);
+        minY = std::min(minY, k.pos.y);
+        maxX = std::max(maxX, k.pos.x + k.size.x);
+        maxY = std::max(maxY, k.pos.y + k.size.y);
+    }
+    grid.originX = minX;
+    grid.originY = minY;
+    grid.cols = static_cast<int>(std::floor((maxX - minX) / cellSize)) + 1;
+    grid.rows = static_cast<int>(std::floor((maxY - minY) / cellSize)) + 1;
+
+    // Count, prefix-sum, then fill, visiting keys in order so each cell's
+    // list stays sorted by key index.
+    std::vector<int> counts(static_cast<std::size_t>(grid.cols) * grid.rows + 1, 0);
+    auto forEachCell = [&](const Key& k, auto&& fn) {
+        int c0 = clampCell(static_cast<int>(std::floor((k.pos.x - minX) / cellSize)), grid.cols);
+        int c1 = clampCell(static_cast<int>(std::floor((k.pos.x + k.size.x - minX) / cellSize)), grid.cols);
+        int r0 = clampCell(static_cast<int>(std::floor((k.pos.y - minY) / cellSize)), grid.rows);
+        int r1 = clampCell(static_cast<int>(std::floor((k.pos.y + k.size.y - minY) / cellSize)), grid.rows);
+        for (int r = r0; r <= r1; r++)
+            for (int c = c0; c <= c1; c++)
+                fn(r * grid.cols + c);
+    };
+    for (const auto& k : keys)
+        forEachCell(k, [&](int cell) { counts[cell + 1]++; });
+    for (std::size_t i = 1; i < counts.size(); i++)
+        counts[i] += counts[i - 1];
+    grid.cellStart = counts;
+    grid.cellKeys.resize(counts.back());
+    for (int i = 0; i < static_cast<int>(keys.size()); i++)
+        forEachCell(keys[i], [&](int cell) { grid.cellKeys[counts[cell]++] = i; });
+}
+
+int findKeyAt(const KeyHitGrid& grid, const std::vector<Key>& keys, double x, double y) {
+    if (grid.cols == 0)
+        return -1;
+    double cx = std::floor((x - grid.originX) / grid.cellSize);
+    double cy = std::floor((y - grid.originY) / grid.cellSize);
+    if (cx < 0.0 || cy < 0.0 || cx >= grid.cols || cy >= grid.rows)
+        return -1;
+
+    int cell = static_cast<int>(cy) * grid.cols + static_cast<int>(cx);
+    for (int i = grid.cellStart[cell]; i < grid.cellStart[cell + 1]; i++) {
+        const Key& k = keys[grid.cellKeys[i]];
+        if (x >= k.pos.x && x <= k.pos.x + k.size.x &&
+            y >= k.pos.y && y <= k.pos.y + k.size.y)
+            return grid.cellKeys[i];
+    }
+    return -1;
+}
+
+// Clips t in [t0, t1] of p + t * d to lo <= x <= hi along one axis
+static bool clipAxis(double p, double d, double lo, double hi, double& t0, double& t1) {
+    if (d == 0.0)
+        return p >= lo && p <= hi;
+    double a = (lo - p) / d, b = (hi - p) / d;
+    if (a > b)
+        std::swap(a, b);
+    t0 = std::max(t0, a);
+    t1 = std::min(t1, b);
+    return t0 <= t1;
+}
+
+int findKeysAlongSegment(const KeyHitGrid& grid, const std::vector<Key>& keys, double x0, double y0, double x1,
+    double y1, KeySegmentHit* hits, int maxHits)
+{
+    if (grid.cols == 0 || maxHits <= 0)
+        return 0;
+    double dx = x1 - x0, dy = y1 - y0;
+    double tStart = 0.0, tEnd = 1.0;
+    double gridRight = grid.originX + grid.cols * grid.cellSize;
+    double gridBottom = grid.originY + grid.rows * grid.cellSize;
+    if (!clipAxis(x0, dx, grid.originX, gridRight, tStart, tEnd)
+        || !clipAxis(y0, dy, grid.originY, gridBottom, tStart, tEnd))
+        return 0;
+
+    // Cell by cell along the segment (Amanatides & Woo)
+    double sx = (x0 + dx * tStart - grid.originX) / grid.cellSize;
+    double sy = (y0 + dy * tStart - grid.originY) / grid.cellSize;
+    int cx = clampCell(static_cast<int>(std::floor(sx)), grid.cols);
+    int cy = clampCell(static_cast<int>(std::floor(sy)), grid.rows);
+    const double never = std::numeric_limits<double>::infinity();
+    int stepX = dx > 0.0 ? 1 : -1, stepY = dy > 0.0 ? 1 : -1;
+    double cellDx = dx / grid.cellSize, cellDy = dy / grid.cellSize;
+    double tDeltaX = dx != 0.0 ? std::abs(1.0 / cellDx) : never;
+    double tDeltaY = dy != 0.0 ? std::abs(1.0 / cellDy) : never;
+    double tMaxX = dx != 0.0 ? tStart + ((cx + (dx > 0.0)) - sx) / cellDx : never;
+    double tMaxY = dy != 0.0 ? tStart + ((cy + (dy > 0.0)) - sy) / cellDy : never;
+
+    int count = 0;
+    for (;;) {
+        int cell = cy * grid.cols + cx;
+        for (int i = grid.cellStart[cell]; i < grid.cellStart[cell + 1]; i++) {
+            int key = grid.cellKeys[i];
+            bool seen = false;
+            for (int h = 0; h < count && !seen; h++)
+                seen = hits[h].key == key;
+            if (seen)
+                continue;
+            const Key& k = keys[key];
+            double enter = 0.0, exit = 1.0;
+            if (!clipAxis(x0, dx, k.pos.x, k.pos.x + k.size.x, enter, exit)
+                || !clipAxis(y0, dy, k.pos.y, k.pos.y + k.size.y, enter, exit))
+                continue;
+            // Insert in entry order; cells are visited in segment order, so
+            // this is almost always an append
+            int at = count;
+            while (at > 0 && hits[at - 1].enter > enter) {
+                hits[at] = hits[at - 1];
+                at--;
+            }
+            hits[at] = { key, static_cast<float>(enter), static_cast<float>(exit) };
+            if (++count == maxHits)
+                return count;
+        }
+
+        if (tMaxX < tMaxY) {
+            if (tMaxX > tEnd)
+                break;
+            cx += stepX;
+            tMaxX += tDeltaX;
+            if (cx < 0 || cx >= grid.cols)
+                break;
+        }
+        else {
+            if (tMaxY > tEnd)
+                break;
+            cy += stepY;
+            tMaxY += tDeltaY;
+            if (cy < 0 || cy >= grid.rows)
+                break;
+        }
+    }
+    return count;
+}
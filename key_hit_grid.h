@@ -0,0 +1,41 @@
+// key_hit_grid.h
+// Uniform grid over the key rectangles for constant-time "which key is under
+// the cursor" queries. Each cell lists the keys overlapping it, in key order.
+
+#pragma once
+
+#include "keyboard.h"
+
+#include <vector>
+
+struct KeyHitGrid {
+    float originX = 0.0f;
+    float originY = 0.0f;
+    float cellSize = 1.0f;
+    int cols = 0;
+    int rows = 0;
+    std::vector<int> cellStart; // cols * rows + 1 offsets into cellKeys
+    std::vector<int> cellKeys;  // key indices
+};
+
+// Rebuild whenever keys are added, removed or moved. A cell size around the
+// key pitch keeps every cell down to a handful of keys.
+void buildKeyHitGrid(KeyHitGrid& grid, const std::vector<Key>& keys, float cellSize);
+
+// Index of the first key (in layout order) whose rectangle contains (x, y),
+// edges included, or -1.
+int findKeyAt(const KeyHitGrid& grid, const std::vector<Key>& keys, double x, double y);
+
+// A key a segment passes through, over [enter, exit] of the segment's length
+// (0 at its start, 1 at its end).
+struct KeySegmentHit {
+    int key;
+    float enter;
+    float exit;
+};
+
+// Every key whose rectangle the segment (x0, y0) -> (x1, y1) touches, in the
+// order the segment enters them, walking only the grid cells it crosses.
+// Writes at most maxHits and returns how many were written.
+int findKeysAlongSegment(const KeyHitGrid& grid, const std::vector<Key>& keys, double x0, double y0, double x1,
+    double y1, KeySegmentHit* hits, int maxHits);
@@ -0,0 +1,162 @@
+// key_state.cpp
+// See key_state.h. Stepping kernels, per lane: d = target - p;
+// p' = |d| <= step ? target : p + clamp(d, -step, step). The snap to target keeps the result exact, the
+// same as the old per-key branchy update.
+
+#include "key_state.h"
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define QG_KEY_STATE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define QG_KEY_STATE_NEON
+#endif
+
+void resetKeyStates(KeyStates& states, std::size_t count) {
+    std::size_t padded = (count + KEY_STATE_LANES - 1) / KEY_STATE_LANES * KEY_STATE_LANES;
+    states.count = count;
+    states.pressAnim.assign(padded, 0.0f);
+    states.target.assign(padded, 0.0f);
+    states.keycapRemoved.assign(count, 0);
+    states.changeTime.assign(count, 0.0);
+    states.heat.assign(count, 0.0f);
+    states.startAnim.assign(count, 0.0f);
+    states.animating.clear();
+    states.animating.reserve(count); // a key is listed at most once, so this never grows
+    states.isAnimating.assign(count, 0);
+}
+
+// -------------------------
+// Analytic Animation
+// -------------------------
+// Progress 0..1 of the move at normalized time u in [0, 1]; 1 at u = 1.
+static float curveProgress(AnimationCurve curve, float u) {
+    switch (curve) {
+    case AnimationCurve::EASE_OUT: {
+        float r = 1.0f - u;
+        return 1.0f - r * r * r;
+    }
+    case AnimationCurve::SPRING:
+        // Decays to ~9% overshoot at u = 0.4 and crosses 1 exactly at u = 1
+        return 1.0f - std::exp(-6.0f * u) * std::cos(2.5f * 3.14159265f * u);
+    case AnimationCurve::LINEAR:
+    default:
+        return u;
+    }
+}
+
+static double moveDuration(const KeyStates& states, std::size_t i) {
+    return states.travelTime * std::fabs(states.target[i] - states.startAnim[i]) / KEY_PRESSED_ANIM;
+}
+
+float keyAnimationAt(const KeyStates& states, std::size_t i, double time) {
+    double duration = moveDuration(states, i);
+    double elapsed = time - states.changeTime[i];
+    if (elapsed >= duration)
+        return states.target[i];
+    float u = elapsed > 0.0 ? static_cast<float>(elapsed / duration) : 0.0f;
+    return states.startAnim[i] + (states.target[i] - states.startAnim[i]) * curveProgress(states.curve, u);
+}
+
+void markKeyAnimating(KeyStates& states, std::size_t i) {
+    if (states.isAnimating[i])
+        return;
+    states.isAnimating[i] = 1;
+    states.animating.push_back(static_cast<std::uint32_t>(i));
+}
+
+void animateKeyTo(KeyStates& states, std::size_t i, bool pressed, double time) {
+    states.startAnim[i] = keyAnimationAt(states, i, time);
+    setKeyPressed(states, i, pressed);
+    states.changeTime[i] = time;
+    markKeyAnimating(states, i);
+}
+
+bool evaluateKeyAnimations(KeyStates& states, double now) {
+    bool moving = !states.animating.empty();
+    for (std::size_t n = 0; n < states.animating.size();) {
+        std::uint32_t i = states.animating[n];
+        states.pressAnim[i] = keyAnimationAt(states, i, now);
+        if (now - states.changeTime[i] < moveDuration(states, i)) {
+            n++;
+            continue;
+        }
+        states.isAnimating[i] = 0;
+        states.animating[n] = states.animating.back();
+        states.animating.pop_back();
+    }
+    return moving;
+}
+
+// -------------------------
+// Fixed-step Kernels
+// -------------------------
+
+bool stepKeyAnimationsScalar(KeyStates& states, float maxStep) {
+    bool moving = false;
+    for (std::size_t i = 0; i < states.count; i++) {
+        float p = states.pressAnim[i];
+        float t = states.target[i];
+        float d = t - p;
+        float next = std::fabs(d) <= maxStep ? t : p + (d > 0.0f ? maxStep : -maxStep);
+        moving |= next != p || next != t;
+        states.pressAnim[i] = next;
+    }
+    return moving;
+}
+
+#if defined(QG_KEY_STATE_SSE2)
+
+bool stepKeyAnimations(KeyStates& states, float maxStep) {
+    float* p = states.pressAnim.data();
+    const float* t = states.target.data();
+    const __m128 step = _mm_set1_ps(maxStep);
+    const __m128 negStep = _mm_set1_ps(-maxStep);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 moving = _mm_setzero_ps();
+    for (std::size_t i = 0; i < states.pressAnim.size(); i += KEY_STATE_LANES) {
+        __m128 vp = _mm_loadu_ps(p + i);
+        __m128 vt = _mm_loadu_ps(t + i);
+        __m128 d = _mm_sub_ps(vt, vp);
+        __m128 stepped = _mm_add_ps(vp, _mm_min_ps(_mm_max_ps(d, negStep), step));
+        __m128 arrive = _mm_cmple_ps(_mm_and_ps(d, absMask), step);
+        __m128 next = _mm_or_ps(_mm_and_ps(arrive, vt), _mm_andnot_ps(arrive, stepped));
+        moving = _mm_or_ps(moving, _mm_or_ps(_mm_cmpneq_ps(next, vp), _mm_cmpneq_ps(next, vt)));
+        _mm_storeu_ps(p + i, next);
+    }
+    return _mm_movemask_ps(moving) != 0;
+}
+
+#elif defined(QG_KEY_STATE_NEON)
+
+bool stepKeyAnimations(KeyStates& states, float maxStep) {
+    float* p = states.pressAnim.data();
+    const float* t = states.target.data();
+    const float32x4_t step = vdupq_n_f32(maxStep);
+    const float32x4_t negStep = vdupq_n_f32(-maxStep);
+    uint32x4_t moving = vdupq_n_u32(0);
+    for (std::size_t i = 0; i < states.pressAnim.size(); i += KEY_STATE_LANES) {
+        float32x4_t vp = vld1q_f32(p + i);
+        float32x4_t vt = vld1q_f32(t + i);
+        float32x4_t d = vsubq_f32(vt, vp);
+        float32x4_t stepped = vaddq_f32(vp, vminq_f32(vmaxq_f32(d, negStep), step));
+        uint32x4_t arrive = vcleq_f32(vabsq_f32(d), step);
+        float32x4_t next = vbslq_f32(arrive, vt, stepped);
+        uint32x4_t atRest = vandq_u32(vceqq_f32(next, vp), vceqq_f32(next, vt));
+        moving = vorrq_u32(moving, vmvnq_u32(atRest));
+        vst1q_f32(p + i, next);
+    }
+    uint32x2_t folded = vorr_u32(vget_low_u32(moving), vget_high_u32(moving));
+    return (vget_lane_u32(folded, 0) | vget_lane_u32(folded, 1)) != 0;
+}
+
+#else
+
+bool stepKeyAnimations(KeyStates& states, float maxStep) {
+    return stepKeyAnimationsScalar(states, maxStep);
+}
+
+#endif
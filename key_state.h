@@ -0,0 +1,75 @@
+// key_state.h
+// Per-frame key state, kept apart from the layout in keyboard.h as structure
+// of arrays so the animation step streams over contiguous floats. Index i
+// matches keyboardKeys[i].
+//
+// Press animations are stored as (changeTime, startAnim, target) and
+// evaluated in closed form, so a key's position at any moment does not depend
+// on the frame rate, and keys at rest are not visited at all. The stepping
+// kernels below remain for fixed-step use and benchmarking.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+constexpr float KEY_PRESSED_ANIM = 0.5f;   // pressAnim of a fully pressed key
+constexpr std::size_t KEY_STATE_LANES = 4; // arrays are padded to a multiple of this
+
+// Shape of the move from startAnim to target
+enum class AnimationCurve : std::uint8_t {
+    LINEAR,   // constant speed, the original press animation
+    EASE_OUT, // cubic: fast start, soft landing
+    SPRING    // damped spring, overshoots slightly and settles
+};
+
+struct KeyStates {
+    std::size_t count = 0;
+    std::vector<float> pressAnim;            // 0.0 (up) to 0.5 (fully pressed)
+    std::vector<float> target;               // KEY_PRESSED_ANIM while pressed, else 0.0
+    std::vector<std::uint8_t> keycapRemoved; // 1 shows the mechanical switch instead
+    std::vector<double> changeTime;          // event time of the last target change
+    std::vector<float> heat;                 // heatmap tint 0..1 (typing_stats.h), 0 when off
+    std::vector<float> startAnim;            // where the key stood at changeTime
+    std::vector<std::uint32_t> animating;    // keys still moving, unordered
+    std::vector<std::uint8_t> isAnimating;   // 1 while listed in animating
+    AnimationCurve curve = AnimationCurve::LINEAR;
+    float travelTime = 0.15f;                // seconds from up to fully pressed;
+                                             // shorter moves take proportionally less
+};
+
+// All keys up, keycaps on. Keeps curve and travelTime.
+void resetKeyStates(KeyStates& states, std::size_t count);
+
+inline bool isKeyPressed(const KeyStates& states, std::size_t i) {
+    return states.target[i] > 0.0f;
+}
+
+inline void setKeyPressed(KeyStates& states, std::size_t i, bool pressed) {
+    states.target[i] = pressed ? KEY_PRESSED_ANIM : 0.0f;
+}
+
+// Where key i's animation puts it at time (not before its changeTime).
+float keyAnimationAt(const KeyStates& states, std::size_t i, double time);
+
+// Retargets key i at time, an event time that may lie before the frame that
+// first shows it, starting from wherever its animation had it then.
+void animateKeyTo(KeyStates& states, std::size_t i, bool pressed, double time);
+
+// Lists key i as moving, for a copy whose target, startAnim and changeTime
+// were just taken from animateKeyTo()'s side.
+void markKeyAnimating(KeyStates& states, std::size_t i);
+
+// Sets pressAnim of every moving key for time now and drops the ones that
+// arrived. Returns true if any key was moving (including on arrival).
+bool evaluateKeyAnimations(KeyStates& states, double now);
+
+// Moves every pressAnim toward its target by at most maxStep, landing exactly
+// on the target. Returns true if any key is still moving or moved this step.
+// Uses SSE2 or NEON when available.
+bool stepKeyAnimations(KeyStates& states, float maxStep);
+
+// Plain loop with the same results, for platforms without SIMD and for
+// benchmarking against.
+bool stepKeyAnimationsScalar(KeyStates& states, float maxStep);
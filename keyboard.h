@@ -0,0 +1,53 @@
+// keyboard.h
+// Key description shared by the simulator and the keyboard renderer. This is
+// the static layout only; the per-frame press state lives in key_state.h.
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+
+// -------------------------
+// Key Types & Colors
+// -------------------------
+enum class KeyType {
+    ALPHANUM,       // Letters, digits, punctuation
+    FUNCTION,       // F-keys and similar
+    MODIFIER,       // Shift, Ctrl, Alt, etc.
+    NAVIGATION,     // Navigation keys (e.g., Ins, Home, PgUp, Del, End, PgDn)
+    ARROW,          // Arrow keys (Up, Down, Left, Right)
+    NUMPAD,         // Numeric keypad (not used now)
+    BACKGROUND_ONLY // For the 'housing'
+};
+
+inline void getBaseColor(KeyType type, float& r, float& g, float& b)
+{
+    switch (type) {
+    case KeyType::FUNCTION:
+        r = 0.8f; g = 0.8f; b = 0.8f;
+        break;
+    case KeyType::MODIFIER:
+        r = 0.85f; g = 0.85f; b = 0.80f;
+        break;
+    case KeyType::NUMPAD:
+        r = 0.90f; g = 0.90f; b = 0.85f;
+        break;
+    case KeyType::ALPHANUM:
+    default:
+        r = 0.93f; g = 0.93f; b = 0.88f;
+        break;
+    }
+}
+
+// -------------------------
+// Key Structure
+// -------------------------
+struct Key {
+    std::string label;
+    glm::vec2 pos;    // Top-left corner position
+    glm::vec2 size;
+    glm::vec2 labelPos;     // Label pen position relative to pos
+    KeyType type;           // For coloring
+    std::uint16_t switchId = 0; // Switch profile (switch_profiles.h): its click and stem
+};
@@ -0,0 +1,845 @@
+// keyboard_renderer.cpp
+// See keyboard_renderer.h. One unit mesh describes a keycap, a switch housing
+// and a switch stem in normalized face coordinates; every key is an instance
+// of it carrying {rect, colors, stem shape, pressAnim, keycapRemoved}, so keys
+// with different switch profiles still share one draw call. The vertex shader
+// places the mesh and applies the shift / sink / compress of the press
+// animation, so the per-frame CPU cost is one small state upload for the keys
+// that changed, independent of layout size.
+// The faces and shading match the old immediate-mode drawKeycap3D /
+// drawMechanicalSwitch3D exactly.
+// Labels are one more instanced draw: every glyph is an instance of a unit
+// quad textured from the glyph atlas, with a copy of its key's state so it
+// follows the keycap.
+// With framebuffer objects available the board is kept in an offscreen target
+// and only the screen rectangles of keys whose state changed are cleared and
+// redrawn (scissored) before the target is copied to the window. The target
+// may be smaller than the window (render scale) and multisampled; it is then
+// resolved at its own size and stretched to the window in one linear blit.
+
+#include "gl_functions.h"
+#include "frame_arena.h"
+#include "keyboard_renderer.h"
+#include "label_atlas.h"
+#include "profiling.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <iostream>
+
+// -------------------------
+// Shaders
+// -------------------------
+static const char* KEYBOARD_VERTEX_SHADER = R"(
+#version 120
+uniform float u_keyDepth;
+
+// Unit mesh
+attribute vec3 a_corner; // xy = 0..1 across the face, z = 1 for the bevelled back corners
+attribute float a_shade; // face brightness offset
+attribute float a_part;  // 0 keycap, 1 switch housing, 2 switch stem
+
+// Per key instance
+attribute vec4 a_rect;   // top-left corner, size
+attribute vec3 a_color;  // keycap base color
+attribute vec3 a_housingColor;
+attribute vec3 a_stemColor;
+attribute vec3 a_stemShape; // switch profile StemGeometry: scale, depth, compress
+attribute vec3 a_state;  // x = pressAnim, y = 1.0 if the keycap is removed, z = heatmap 0..1
+
+varying vec3 v_color;
+
+const vec3 HEAT_COLOR = vec3(0.95, 0.35, 0.2); // keycap color at full heat
+
+void main() {
+    float press = a_state.x;
+    bool removed = a_state.y > 0.5;
+    bool isKeycap = a_part < 0.5;
+    if (isKeycap == removed) {
+        // Hidden part: park it outside the clip volume
+        v_color = vec3(0.0);
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+
+    vec3 pos;
+    if (isKeycap) {
+        float shift = 10.0 * press;                        // SHIFT left and up
+        float sink = u_keyDepth * press;                   // SINK into the screen
+        float depth = u_keyDepth * (1.0 - 0.5 * press);    // COMPRESS the bevel
+        vec2 xy = a_rect.xy + a_corner.xy * a_rect.zw - vec2(shift + depth * a_corner.z);
+        pos = vec3(xy, -(sink + depth * a_corner.z));
+        v_color = mix(a_color, HEAT_COLOR, a_state.z) + vec3(a_shade);
+    }
+    else {
+        // Outer "switch housing"
+        vec2 housingPos = a_rect.xy + a_rect.zw * 0.3;
+        vec2 housingSize = a_rect.zw * 0.4;
+        float outerDepth = 16.0 * (u_keyDepth / 15.0);
+
+        if (a_part < 1.5) {
+            float bevel = outerDepth * 0.5;
+            pos = vec3(housingPos + a_corner.xy * housingSize - vec2(bevel * a_corner.z),
+                -outerDepth * a_corner.z);
+            v_color = a_housingColor + vec3(a_shade);
+        }
+        else {
+            // Inner "stem": half the keycap's shift, its sink, and the travel
+            // from resting to pressed depth over pressAnim 0 -> 0.5
+            float cloneScale = a_stemShape.x;
+            vec2 stemSize = housingSize * cloneScale;
+            vec2 stemPos = housingPos + (housingSize - stemSize) * 0.5 + vec2(2.0);
+            float restDepth = (outerDepth - 6.0) * cloneScale * a_stemShape.y;
+            float stemDepth = restDepth * (1.0 - a_stemShape.z * press);
+            float restingZ = -(restDepth / 2.0);
+            float pressedZ = -(restDepth - 1.0);
+            float zTranslation = restingZ + (press / 0.5) * (pressedZ - restingZ);
+            vec3 offset = vec3(-5.0 * press, -5.0 * press, zTranslation - u_keyDepth * press);
+            float bevel = stemDepth * 0.5;
+            pos = vec3(stemPos + a_corner.xy * stemSize - vec2(bevel * a_corner.z),
+                -stemDepth * a_corner.z) + offset;
+            // The stem shows through the front of its housing: lift it, at
+            // its deepest travel, in front of the housing's front face (z = 0).
+            // The projection is orthographic, so z only decides visibility.
+            pos.z += 2.0 * restDepth + 0.5 * u_keyDepth + 0.5;
+            v_color = a_stemColor + vec3(a_shade);
+        }
+    }
+    gl_Position = gl_ModelViewProjectionMatrix * vec4(pos, 1.0);
+}
+)";
+
+static const char* KEYBOARD_FRAGMENT_SHADER = R"(
+#version 120
+varying vec3 v_color;
+
+void main() {
+    gl_FragColor = vec4(v_color, 1.0);
+}
+)";
+
+static const char* LABEL_VERTEX_SHADER = R"(
+#version 120
+attribute vec3 a_corner;    // unit quad corner
+attribute vec4 a_glyphRect; // resting top-left corner, size
+attribute vec4 a_glyphUv;   // atlas u0 v0 u1 v1
+attribute vec2 a_state;     // owning key's pressAnim, keycapRemoved
+
+varying vec2 v_uv;
+
+void main() {
+    v_uv = mix(a_glyphUv.xy, a_glyphUv.zw, a_corner.xy);
+    if (a_state.y > 0.5) {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+    vec2 shift = vec2(10.0 * a_state.x); // follow the keycap's shift
+    vec2 xy = a_glyphRect.xy + a_corner.xy * a_glyphRect.zw - shift;
+    gl_Position = gl_ModelViewProjectionMatrix * vec4(xy, 0.0, 1.0);
+}
+)";
+
+static const char* LABEL_FRAGMENT_SHADER = R"(
+#version 120
+uniform sampler2D u_atlas;
+uniform vec3 u_color;
+varying vec2 v_uv;
+
+void main() {
+    if (texture2D(u_atlas, v_uv).a < 0.5)
+        discard;
+    gl_FragColor = vec4(u_color, 1.0);
+}
+)";
+
+enum KeyboardAttrib : GLuint {
+    ATTRIB_CORNER,
+    ATTRIB_SHADE,
+    ATTRIB_PART,
+    ATTRIB_RECT,
+    ATTRIB_COLOR,
+    ATTRIB_HOUSING_COLOR,
+    ATTRIB_STEM_COLOR,
+    ATTRIB_STEM_SHAPE,
+    ATTRIB_STATE,
+    ATTRIB_COUNT
+};
+
+static const char* const KEYBOARD_ATTRIBS[ATTRIB_COUNT] = {
+    "a_corner", "a_shade", "a_part", "a_rect", "a_color", "a_housingColor", "a_stemColor", "a_stemShape", "a_state"
+};
+
+enum LabelAttrib : GLuint {
+    LABEL_ATTRIB_CORNER,
+    LABEL_ATTRIB_RECT,
+    LABEL_ATTRIB_UV,
+    LABEL_ATTRIB_STATE,
+    LABEL_ATTRIB_COUNT
+};
+
+static const char* const LABEL_ATTRIBS[LABEL_ATTRIB_COUNT] = {
+    "a_corner", "a_glyphRect", "a_glyphUv", "a_state"
+};
+
+// -------------------------
+// Mesh Data
+// -------------------------
+enum MeshPart {
+    PART_KEYCAP,
+    PART_HOUSING,
+    PART_STEM,
+    PART_LABEL
+};
+
+struct UnitVertex {
+    glm::vec3 corner;
+    float shade;
+    float part;
+};
+
+struct KeyInstance {
+    float rect[4];
+    glm::vec3 color;
+    glm::vec3 housingColor;         // from the key's switch profile
+    glm::vec3 stemColor;
+    float stemShape[3];
+};
+
+struct KeyState {
+    float pressAnim = 0.0f;
+    float keycapRemoved = 0.0f;
+    float heat = 0.0f;              // labels ignore it
+};
+
+struct GlyphInstance {
+    float rect[4];
+    float uv[4];
+};
+
+// Glyph instances of one key's label
+struct LabelRange {
+    std::size_t first = 0;
+    std::size_t count = 0;
+};
+
+// Axis-aligned rectangle in board units
+struct DirtyRect {
+    float x0, y0, x1, y1;
+};
+
+// Past this many dirty keys in one frame, redraw their bounding box instead
+constexpr std::size_t MAX_DIRTY_RECTS = 8;
+// Glyphs one drawOverlayText() call can place; the rest of the text is cut
+constexpr std::size_t MAX_OVERLAY_GLYPHS = 2048;
+
+struct KeyboardRenderer {
+    GLuint program = 0;
+    GLint keyDepthLocation = -1;
+    GLuint meshVbo = 0;
+    GLuint meshIbo = 0;
+    GLuint instanceVbo = 0;
+    GLuint stateVbo = 0;
+    GLsizei bodyIndexCount = 0;     // keycaps and housings
+    GLsizei stemIndexCount = 0;     // stems, placed in front of their housing
+    GLsizei labelIndexCount = 0;    // one quad for label glyphs
+    GLsizei instanceCount = 0;
+    float keyDepth = 0.0f;
+
+    std::vector<KeyState> state;    // CPU mirror of stateVbo
+
+    GLuint labelProgram = 0;
+    GLint atlasLocation = -1;
+    GLint labelColorLocation = -1;
+    GlyphAtlas atlas;
+    GLuint glyphVbo = 0;
+    GLuint glyphStateVbo = 0;
+    GLsizei glyphCount = 0;
+    std::vector<LabelRange> labels;     // per key
+    std::vector<KeyState> glyphState;   // CPU mirror of glyphStateVbo
+
+    // Overlay text, rebuilt per call
+    GLuint overlayVbo = 0;
+
+    // Cached board (0 when framebuffer objects are unavailable)
+    GLuint fbo = 0;
+    GLuint colorRbo = 0;
+    GLuint depthRbo = 0;
+    GLuint resolveFbo = 0;              // single-sample copy of a multisampled fbo
+    GLuint resolveRbo = 0;
+    int targetWidth = 0;
+    int targetHeight = 0;
+    int targetSamples = 0;
+    std::size_t targetBytes = 0;
+    int windowWidth = 0;                // window framebuffer the target is copied to
+    int windowHeight = 0;
+    float pixelScale = 1.0f;            // target pixels per board unit
+    bool fullRedraw = true;
+    std::vector<DirtyRect> keyBounds;   // everything a key can touch, any pressAnim
+
+    // Per-frame scratch, sized by buildKeyboardMesh() and emptied at the
+    // start of every drawKeyboard(): this frame's dirty rectangles, then any
+    // overlay glyphs
+    FrameArena frame;
+    DirtyRect* dirty = nullptr;
+    std::size_t dirtyCount = 0;
+};
+
+static KeyboardRenderer g_renderer;
+
+// Same base color drawKeycap3D used for every key
+static const glm::vec3 KEYCAP_COLOR(0.9f, 0.9f, 0.85f);
+
+// -------------------------
+// Unit Mesh
+// -------------------------
+// Faces in the order and shading of the old immediate-mode code.
+struct UnitFace {
+    float corners[4][3];
+    float shade;
+};
+
+static const UnitFace FACE_FRONT  = { { {0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0} }, 0.0f };
+static const UnitFace FACE_TOP    = { { {0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1} }, 0.07f };
+static const UnitFace FACE_RIGHT  = { { {1, 0, 0}, {1, 1, 0}, {1, 1, 1}, {1, 0, 1} }, -0.05f };
+static const UnitFace FACE_BOTTOM = { { {0, 1, 0}, {1, 1, 0}, {1, 1, 1}, {0, 1, 1} }, -0.02f };
+static const UnitFace FACE_LEFT   = { { {0, 0, 0}, {0, 1, 0}, {0, 1, 1}, {0, 0, 1} }, -0.03f };
+
+static void appendFace(std::vector<UnitVertex>& vertices, std::vector<GLushort>& indices,
+    const UnitFace& face, MeshPart part)
+{
+    GLushort base = static_cast<GLushort>(vertices.size());
+    for (const auto& c : face.corners)
+        vertices.push_back({ glm::vec3(c[0], c[1], c[2]), face.shade, static_cast<float>(part) });
+    const GLushort quad[6] = { 0, 1, 2, 0, 2, 3 };
+    for (GLushort i : quad)
+        indices.push_back(static_cast<GLushort>(base + i));
+}
+
+static void buildUnitMesh() {
+    std::vector<UnitVertex> vertices;
+    std::vector<GLushort> indices;
+
+    // Keycap and housing: all five faces
+    for (MeshPart part : { PART_KEYCAP, PART_HOUSING }) {
+        for (const UnitFace* face : { &FACE_FRONT, &FACE_TOP, &FACE_RIGHT, &FACE_BOTTOM, &FACE_LEFT })
+            appendFace(vertices, indices, *face, part);
+    }
+    g_renderer.bodyIndexCount = static_cast<GLsizei>(indices.size());
+
+    // Stem: front, top and left only (drawThreeFacedCube)
+    for (const UnitFace* face : { &FACE_FRONT, &FACE_TOP, &FACE_LEFT })
+        appendFace(vertices, indices, *face, PART_STEM);
+    g_renderer.stemIndexCount = static_cast<GLsizei>(indices.size()) - g_renderer.bodyIndexCount;
+
+    // Label glyph quad
+    appendFace(vertices, indices, FACE_FRONT, PART_LABEL);
+    g_renderer.labelIndexCount = 6;
+
+    glBindBuffer(GL_ARRAY_BUFFER, g_renderer.meshVbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(UnitVertex), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_renderer.meshIbo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), indices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+static void setAttrib(GLuint attrib, GLint size, GLsizei stride, std::size_t offset, GLuint divisor) {
+    glVertexAttribPointer(attrib, size, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const void*>(offset));
+    glVertexAttribDivisor(attrib, divisor);
+    glEnableVertexAttribArray(attrib);
+}
+
+static void destroyTarget() {
+    if (g_renderer.fbo)
+        glDeleteFramebuffers(1, &g_renderer.fbo);
+    if (g_renderer.resolveFbo)
+        glDeleteFramebuffers(1, &g_renderer.resolveFbo);
+    if (g_renderer.colorRbo)
+        glDeleteRenderbuffers(1, &g_renderer.colorRbo);
+    if (g_renderer.depthRbo)
+        glDeleteRenderbuffers(1, &g_renderer.depthRbo);
+    if (g_renderer.resolveRbo)
+        glDeleteRenderbuffers(1, &g_renderer.resolveRbo);
+    g_renderer.fbo = g_renderer.resolveFbo = 0;
+    g_renderer.colorRbo = g_renderer.depthRbo = g_renderer.resolveRbo = 0;
+    g_renderer.targetSamples = 0;
+    g_renderer.targetBytes = 0;
+}
+
+// Offscreen bytes for a target: RGBA8 color and 24-bit depth (padded to 32)
+// per sample, plus the single-sample resolve copy when multisampled
+static std::size_t targetBytes(int width, int height, int samples) {
+    std::size_t pixels = static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+    return pixels * 8 * static_cast<std::size_t>(std::max(samples, 1)) + (samples > 0 ? pixels * 4 : 0);
+}
+
+// A complete framebuffer with a color (and optionally depth) renderbuffer
+static GLuint createFramebuffer(int width, int height, int samples, GLuint& color, GLuint* depth) {
+    auto storage = [&](GLenum format) {
+        if (samples > 0)
+            glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, format, width, height);
+        else
+            glRenderbufferStorage(GL_RENDERBUFFER, format, width, height);
+    };
+    glGenRenderbuffers(1, &color);
+    glBindRenderbuffer(GL_RENDERBUFFER, color);
+    storage(GL_RGBA8);
+    if (depth) {
+        glGenRenderbuffers(1, depth);
+        glBindRenderbuffer(GL_RENDERBUFFER, *depth);
+        storage(GL_DEPTH_COMPONENT24);
+    }
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    GLuint fbo = 0;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+    if (depth)
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, *depth);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status == GL_FRAMEBUFFER_COMPLETE)
+        return fbo;
+    glDeleteFramebuffers(1, &fbo);
+    return 0;
+}
+
+// -------------------------
+// Public Interface
+// -------------------------
+bool initKeyboardRenderer() {
+    g_renderer.program = buildShaderProgram(KEYBOARD_VERTEX_SHADER, KEYBOARD_FRAGMENT_SHADER,
+        KEYBOARD_ATTRIBS, ATTRIB_COUNT);
+    if (!g_renderer.program)
+        return false;
+    g_renderer.keyDepthLocation = glGetUniformLocation(g_renderer.program, "u_keyDepth");
+
+    g_renderer.labelProgram = buildShaderProgram(LABEL_VERTEX_SHADER, LABEL_FRAGMENT_SHADER,
+        LABEL_ATTRIBS, LABEL_ATTRIB_COUNT);
+    if (!g_renderer.labelProgram || !buildGlyphAtlas(g_renderer.atlas)) {
+        shutdownKeyboardRenderer();
+        return false;
+    }
+    g_renderer.atlasLocation = glGetUniformLocation(g_renderer.labelProgram, "u_atlas");
+    g_renderer.labelColorLocation = glGetUniformLocation(g_renderer.labelProgram, "u_color");
+
+    glGenBuffers(1, &g_renderer.meshVbo);
+    glGenBuffers(1, &g_renderer.meshIbo);
+    glGenBuffers(1, &g_renderer.instanceVbo);
+    glGenBuffers(1, &g_renderer.stateVbo);
+    glGenBuffers(1, &g_renderer.glyphVbo);
+    glGenBuffers(1, &g_renderer.glyphStateVbo);
+    glGenBuffers(1, &g_renderer.overlayVbo);
+    buildUnitMesh();
+    return true;
+}
+
+void shutdownKeyboardRenderer() {
+    if (!g_renderer.program)
+        return;
+    glDeleteBuffers(1, &g_renderer.meshVbo);
+    glDeleteBuffers(1, &g_renderer.meshIbo);
+    glDeleteBuffers(1, &g_renderer.instanceVbo);
+    glDeleteBuffers(1, &g_renderer.stateVbo);
+    glDeleteBuffers(1, &g_renderer.glyphVbo);
+    glDeleteBuffers(1, &g_renderer.glyphStateVbo);
+    glDeleteBuffers(1, &g_renderer.overlayVbo);
+    destroyTarget();
+    destroyGlyphAtlas(g_renderer.atlas);
+    if (g_renderer.labelProgram)
+        glDeleteProgram(g_renderer.labelProgram);
+    glDeleteProgram(g_renderer.program);
+    g_renderer = KeyboardRenderer();
+}
+
+static void growRect(DirtyRect& r, const DirtyRect& other) {
+    r.x0 = std::min(r.x0, other.x0);
+    r.y0 = std::min(r.y0, other.y0);
+    r.x1 = std::max(r.x1, other.x1);
+    r.y1 = std::max(r.y1, other.y1);
+}
+
+void setKeyboardTarget(int framebufferWidth, int framebufferHeight, float pixelScale,
+    const KeyboardTargetSettings& settings)
+{
+    float renderScale = std::min(std::max(settings.renderScale, MIN_RENDER_SCALE), 1.0f);
+    int width = std::max(1, static_cast<int>(std::lround(framebufferWidth * renderScale)));
+    int height = std::max(1, static_cast<int>(std::lround(framebufferHeight * renderScale)));
+    g_renderer.windowWidth = framebufferWidth;
+    g_renderer.windowHeight = framebufferHeight;
+    g_renderer.pixelScale = pixelScale * static_cast<float>(width) / static_cast<float>(std::max(framebufferWidth, 1));
+    g_renderer.fullRedraw = true;
+
+    // Multisampling only as far as the budget (and the driver) allows
+    int samples = hasFramebufferObjects() ? std::max(settings.samples, 0) : 0;
+    if (samples > 0) {
+        GLint maxSamples = 0;
+        glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+        samples = std::min(samples, static_cast<int>(maxSamples));
+    }
+    while (samples > 0 && settings.memoryBudget > 0 && targetBytes(width, height, samples) > settings.memoryBudget)
+        samples /= 2;
+    if (samples == 1)
+        samples = 0; // one sample costs a resolve and buys nothing
+
+    if (width == g_renderer.targetWidth && height == g_renderer.targetHeight && samples == g_renderer.targetSamples
+        && g_renderer.fbo)
+        return;
+    destroyTarget();
+    g_renderer.targetWidth = width;
+    g_renderer.targetHeight = height;
+    if (!hasFramebufferObjects() || framebufferWidth <= 0 || framebufferHeight <= 0)
+        return;
+
+    g_renderer.fbo = createFramebuffer(width, height, samples, g_renderer.colorRbo, &g_renderer.depthRbo);
+    if (g_renderer.fbo && samples > 0)
+        g_renderer.resolveFbo = createFramebuffer(width, height, 0, g_renderer.resolveRbo, nullptr);
+    if (!g_renderer.fbo || (samples > 0 && !g_renderer.resolveFbo)) {
+        std::cerr << "Error: Keyboard framebuffer incomplete, redrawing the full board every frame\n";
+        destroyTarget();
+        return;
+    }
+    g_renderer.targetSamples = samples;
+    g_renderer.targetBytes = targetBytes(width, height, samples);
+}
+
+KeyboardTargetInfo getKeyboardTargetInfo() {
+    KeyboardTargetInfo info;
+    if (g_renderer.fbo) {
+        info.width = g_renderer.targetWidth;
+        info.height = g_renderer.targetHeight;
+        info.samples = g_renderer.targetSamples;
+        info.bytes = g_renderer.targetBytes;
+    }
+    return info;
+}
+
+void invalidateKeyboard() {
+    g_renderer.fullRedraw = true;
+}
+
+void buildKeyboardMesh(const std::vector<Key>& keys, float keyDepth,
+    const SwitchProfile* profiles, int profileCount)
+{
+    std::vector<KeyInstance> instances(keys.size());
+    g_renderer.state.assign(keys.size(), KeyState()); // at rest until drawKeyboard() sees otherwise
+    g_renderer.keyBounds.resize(keys.size());
+    g_renderer.frame.reserve(keys.size() * sizeof(DirtyRect) + MAX_OVERLAY_GLYPHS * sizeof(GlyphInstance)
+        + alignof(GlyphInstance));
+
+    // The keycap's back corners reach up/left by its depth plus the press
+    // shift; everything else stays inside the key rectangle.
+    float reach = std::max(keyDepth, 5.0f + 0.75f * keyDepth) + 1.0f;
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        const Key& k = keys[i];
+        const SwitchProfile& profile = k.switchId < profileCount ? profiles[k.switchId] : profiles[0];
+        instances[i] = { { k.pos.x, k.pos.y, k.size.x, k.size.y }, KEYCAP_COLOR,
+            profile.housingColor, profile.stemColor,
+            { profile.stem.scale, profile.stem.depth, profile.stem.compress } };
+        g_renderer.keyBounds[i] = { k.pos.x - reach, k.pos.y - reach,
+            k.pos.x + k.size.x + 1.0f, k.pos.y + k.size.y + 1.0f };
+    }
+    g_renderer.instanceCount = static_cast<GLsizei>(keys.size());
+    g_renderer.keyDepth = keyDepth;
+    g_renderer.fullRedraw = true;
+
+    glBindBuffer(GL_ARRAY_BUFFER, g_renderer.instanceVbo);
+    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(KeyInstance), instances.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, g_renderer.stateVbo);
+    glBufferData(GL_ARRAY_BUFFER, g_renderer.state.size() * sizeof(KeyState), g_renderer.state.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void buildKeyboardLabels(const std::vector<Key>& keys, const std::vector<glm::vec2>& anchors) {
+    std::vector<GlyphInstance> glyphs;
+    g_renderer.labels.assign(keys.size(), LabelRange());
+    g_renderer.glyphState.clear();
+    for (std::size_t i = 0; i < keys.size() && i < anchors.size(); i++) {
+        const Key& k = keys[i];
+        LabelRange& range = g_renderer.labels[i];
+        range.first = glyphs.size();
+
+        // Same pen walk as stb_easy_font_print
+        float penX = anchors[i].x;
+        for (char c : k.label) {
+            const GlyphInfo& g = findGlyph(g_renderer.atlas, c);
+            if (g.x1 > g.x0) {
+                glyphs.push_back({ { penX + g.x0, anchors[i].y + g.y0, g.x1 - g.x0, g.y1 - g.y0 },
+                    { g.u0, g.v0, g.u1, g.v1 } });
+                if (i < g_renderer.keyBounds.size()) {
+                    // Labels shift with the keycap by up to 5 units
+                    const GlyphInstance& gi = glyphs.back();
+                    growRect(g_renderer.keyBounds[i], { gi.rect[0] - 6.0f, gi.rect[1] - 6.0f,
+                        gi.rect[0] + gi.rect[2] + 1.0f, gi.rect[1] + gi.rect[3] + 1.0f });
+                }
+            }
+            penX += g.advance;
+        }
+        range.count = glyphs.size() - range.first;
+        g_renderer.glyphState.insert(g_renderer.glyphState.end(), range.count,
+            i < g_renderer.state.size() ? g_renderer.state[i] : KeyState());
+    }
+    g_renderer.glyphCount = static_cast<GLsizei>(glyphs.size());
+    g_renderer.fullRedraw = true;
+
+    glBindBuffer(GL_ARRAY_BUFFER, g_renderer.glyphVbo);
+    glBufferData(GL_ARRAY_BUFFER, glyphs.size() * sizeof(GlyphInstance), glyphs.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, g_renderer.glyphStateVbo);
+    glBufferData(GL_ARRAY_BUFFER, g_renderer.glyphState.size() * sizeof(KeyState),
+        g_renderer.glyphState.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Copies a changed key state onto its label glyphs and widens the dirty span.
+static void updateLabelState(std::size_t key, const KeyState& next,
+    std::size_t& dirtyBegin, std::size_t& dirtyEnd)
+{
+    if (key >= g_renderer.labels.size())
+        return;
+    const LabelRange& range = g_renderer.labels[key];
+    if (range.count == 0)
+        return;
+    for (std::size_t g = range.first; g < range.first + range.count; g++)
+        g_renderer.glyphState[g] = next;
+    if (range.first < dirtyBegin)
+        dirtyBegin = range.first;
+    if (range.first + range.count > dirtyEnd)
+        dirtyEnd = range.first + range.count;
+}
+
+// Pulls the state of every key that changed into the CPU mirrors, uploads
+// the spans they cover and records their screen rectangles in g_renderer.dirty.
+static void updateKeyState(const KeyStates& states) {
+    std::size_t dirtyBegin = states.count;
+    std::size_t dirtyEnd = 0;
+    std::size_t labelDirtyBegin = g_renderer.glyphState.size();
+    std::size_t labelDirtyEnd = 0;
+    g_renderer.dirty = g_renderer.frame.allocate<DirtyRect>(states.count);
+    g_renderer.dirtyCount = 0;
+    for (std::size_t i = 0; i < states.count; i++) {
+        KeyState next;
+        next.pressAnim = states.pressAnim[i];
+        next.keycapRemoved = states.keycapRemoved[i] ? 1.0f : 0.0f;
+        next.heat = states.heat[i];
+        KeyState& cur = g_renderer.state[i];
+        if (next.pressAnim == cur.pressAnim && next.keycapRemoved == cur.keycapRemoved && next.heat == cur.heat)
+            continue;
+        cur = next;
+        updateLabelState(i, next, labelDirtyBegin, labelDirtyEnd);
+        g_renderer.dirty[g_renderer.dirtyCount++] = g_renderer.keyBounds[i];
+        if (i < dirtyBegin)
+            dirtyBegin = i;
+        dirtyEnd = i + 1;
+    }
+
+    if (dirtyBegin < dirtyEnd) {
+        glBindBuffer(GL_ARRAY_BUFFER, g_renderer.stateVbo);
+        glBufferSubData(GL_ARRAY_BUFFER, dirtyBegin * sizeof(KeyState),
+            (dirtyEnd - dirtyBegin) * sizeof(KeyState), &g_renderer.state[dirtyBegin]);
+    }
+    if (labelDirtyBegin < labelDirtyEnd) {
+        glBindBuffer(GL_ARRAY_BUFFER, g_renderer.glyphStateVbo);
+        glBufferSubData(GL_ARRAY_BUFFER, labelDirtyBegin * sizeof(KeyState),
+            (labelDirtyEnd - labelDirtyBegin) * sizeof(KeyState), &g_renderer.glyphState[labelDirtyBegin]);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (g_renderer.dirtyCount > MAX_DIRTY_RECTS) {
+        DirtyRect all = g_renderer.dirty[0];
+        for (std::size_t i = 1; i < g_renderer.dirtyCount; i++)
+            growRect(all, g_renderer.dirty[i]);
+        g_renderer.dirty[0] = all;
+        g_renderer.dirtyCount = 1;
+    }
+}
+
+static void drawLabels() {
+    if (g_renderer.glyphCount == 0)
+        return;
+    glUseProgram(g_renderer.labelProgram);
+    glUniform1i(g_renderer.atlasLocation, 0);
+    glUniform3f(g_renderer.labelColorLocation, 0.0f, 0.0f, 0.0f);
+    glBindTexture(GL_TEXTURE_2D, g_renderer.atlas.texture);
+
+    glBindBuffer(GL_ARRAY_BUFFER, g_renderer.meshVbo);
+    setAttrib(LABEL_ATTRIB_CORNER, 3, sizeof(UnitVertex), offsetof(UnitVertex, corner), 0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, g_renderer.glyphVbo);
+    setAttrib(LABEL_ATTRIB_RECT, 4, sizeof(GlyphInstance), offsetof(GlyphInstance, rect), 1);
+    setAttrib(LABEL_ATTRIB_UV, 4, sizeof(GlyphInstance), offsetof(GlyphInstance, uv), 1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, g_renderer.glyphStateVbo);
+    setAttrib(LABEL_ATTRIB_STATE, 2, sizeof(KeyState), 0, 1);
+
+    // Labels always sit on top of the keys
+    glDisable(GL_DEPTH_TEST);
+    glDrawElementsInstanced(GL_TRIANGLES, g_renderer.labelIndexCount, GL_UNSIGNED_SHORT,
+        reinterpret_cast<const void*>((g_renderer.bodyIndexCount + g_renderer.stemIndexCount) * sizeof(GLushort)),
+        g_renderer.glyphCount);
+    glEnable(GL_DEPTH_TEST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// Clears (color and depth, current clear color) and draws the whole board into
+// the bound framebuffer; the scissor decides how much of it is touched.
+static void drawBoard() {
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glEnable(GL_DEPTH_TEST);
+
+    glUseProgram(g_renderer.program);
+    glUniform1f(g_renderer.keyDepthLocation, g_renderer.keyDepth);
+
+    glBindBuffer(GL_ARRAY_BUFFER, g_renderer.meshVbo);
+    setAttrib(ATTRIB_CORNER, 3, sizeof(UnitVertex), offsetof(UnitVertex, corner), 0);
+    setAttrib(ATTRIB_SHADE, 1, sizeof(UnitVertex), offsetof(UnitVertex, shade), 0);
+    setAttrib(ATTRIB_PART, 1, sizeof(UnitVertex), offsetof(UnitVertex, part), 0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, g_renderer.instanceVbo);
+    setAttrib(ATTRIB_RECT, 4, sizeof(KeyInstance), offsetof(KeyInstance, rect), 1);
+    setAttrib(ATTRIB_COLOR, 3, sizeof(KeyInstance), offsetof(KeyInstance, color), 1);
+    setAttrib(ATTRIB_HOUSING_COLOR, 3, sizeof(KeyInstance), offsetof(KeyInstance, housingColor), 1);
+    setAttrib(ATTRIB_STEM_COLOR, 3, sizeof(KeyInstance), offsetof(KeyInstance, stemColor), 1);
+    setAttrib(ATTRIB_STEM_SHAPE, 3, sizeof(KeyInstance), offsetof(KeyInstance, stemShape), 1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, g_renderer.stateVbo);
+    setAttrib(ATTRIB_STATE, 3, sizeof(KeyState), 0, 1);
+
+    // Keycaps, housings and stems in one draw: the shader places every stem
+    // in front of its housing, so plain depth testing orders them.
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_renderer.meshIbo);
+    glDrawElementsInstanced(GL_TRIANGLES, g_renderer.bodyIndexCount + g_renderer.stemIndexCount,
+        GL_UNSIGNED_SHORT, nullptr, g_renderer.instanceCount);
+
+    // The label glyphs, from the same unit mesh buffers. Attributes the label
+    // program does not rebind still point at per-key buffers, which hold
+    // fewer entries than there are glyphs: turn them off first.
+    for (GLuint i = LABEL_ATTRIB_COUNT; i < ATTRIB_COUNT; i++) {
+        glVertexAttribDivisor(i, 0);
+        glDisableVertexAttribArray(i);
+    }
+    drawLabels();
+
+    for (GLuint i = 0; i < ATTRIB_COUNT; i++) {
+        glVertexAttribDivisor(i, 0);
+        glDisableVertexAttribArray(i);
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glUseProgram(0);
+}
+
+// Board units to a framebuffer-pixel scissor box (GL's origin is bottom-left)
+static void scissorTo(const DirtyRect& r) {
+    float scale = g_renderer.pixelScale;
+    int x0 = std::max(0, static_cast<int>(std::floor(r.x0 * scale)));
+    int x1 = std::min(g_renderer.targetWidth, static_cast<int>(std::ceil(r.x1 * scale)));
+    int top = std::max(0, static_cast<int>(std::floor(r.y0 * scale)));
+    int bottom = std::min(g_renderer.targetHeight, static_cast<int>(std::ceil(r.y1 * scale)));
+    glScissor(x0, g_renderer.targetHeight - bottom, std::max(0, x1 - x0), std::max(0, bottom - top));
+}
+
+void drawKeyboard(const KeyStates& states) {
+    QG_ZONE("drawKeyboard");
+    g_renderer.frame.reset();
+    if (static_cast<GLsizei>(states.count) != g_renderer.instanceCount)
+        return; // layout changed without buildKeyboardMesh()
+
+    updateKeyState(states);
+    if (!g_renderer.fbo) {
+        drawBoard();
+        return;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, g_renderer.fbo);
+    glViewport(0, 0, g_renderer.targetWidth, g_renderer.targetHeight);
+    if (g_renderer.fullRedraw) {
+        drawBoard();
+        g_renderer.fullRedraw = false;
+    }
+    else if (g_renderer.dirtyCount > 0) {
+        glEnable(GL_SCISSOR_TEST);
+        for (std::size_t i = 0; i < g_renderer.dirtyCount; i++) {
+            scissorTo(g_renderer.dirty[i]);
+            drawBoard();
+        }
+        glDisable(GL_SCISSOR_TEST);
+    }
+
+    // A multisampled target resolves at its own size first: a blit that
+    // resolves cannot also scale
+    GLuint source = g_renderer.fbo;
+    if (g_renderer.resolveFbo) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, g_renderer.fbo);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, g_renderer.resolveFbo);
+        glBlitFramebuffer(0, 0, g_renderer.targetWidth, g_renderer.targetHeight,
+            0, 0, g_renderer.targetWidth, g_renderer.targetHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        source = g_renderer.resolveFbo;
+    }
+
+    // The window's back buffer is undefined after a swap, so copy it all
+    bool scaled = g_renderer.targetWidth != g_renderer.windowWidth || g_renderer.targetHeight != g_renderer.windowHeight;
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, source);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, g_renderer.targetWidth, g_renderer.targetHeight,
+        0, 0, g_renderer.windowWidth, g_renderer.windowHeight, GL_COLOR_BUFFER_BIT, scaled ? GL_LINEAR : GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, g_renderer.windowWidth, g_renderer.windowHeight); // overlays draw at full size
+}
+
+void drawOverlayText(const char* text, float x, float y, const glm::vec3& color) {
+    GlyphInstance* glyphs = g_renderer.frame.allocate<GlyphInstance>(MAX_OVERLAY_GLYPHS);
+    if (!glyphs)
+        return; // no mesh built yet, or a second overlay this frame
+    std::size_t glyphCount = 0;
+
+    // Same pen walk as stb_easy_font_print, including its 12 unit line feed
+    float penX = x, penY = y;
+    for (const char* p = text; *p && glyphCount < MAX_OVERLAY_GLYPHS; p++) {
+        char c = *p;
+        if (c == '\n') {
+            penX = x;
+            penY += 12.0f;
+            continue;
+        }
+        const GlyphInfo& g = findGlyph(g_renderer.atlas, c);
+        if (g.x1 > g.x0) {
+            glyphs[glyphCount++] = { { penX + g.x0, penY + g.y0, g.x1 - g.x0, g.y1 - g.y0 },
+                { g.u0, g.v0, g.u1, g.v1 } };
+        }
+        penX += g.advance;
+    }
+    if (glyphCount == 0)
+        return;
+
+    glUseProgram(g_renderer.labelProgram);
+    glUniform1i(g_renderer.atlasLocation, 0);
+    glUniform3f(g_renderer.labelColorLocation, color.x, color.y, color.z);
+    glBindTexture(GL_TEXTURE_2D, g_renderer.atlas.texture);
+
+    glBindBuffer(GL_ARRAY_BUFFER, g_renderer.meshVbo);
+    setAttrib(LABEL_ATTRIB_CORNER, 3, sizeof(UnitVertex), offsetof(UnitVertex, corner), 0);
+    glBindBuffer(GL_ARRAY_BUFFER, g_renderer.overlayVbo);
+    glBufferData(GL_ARRAY_BUFFER, glyphCount * sizeof(GlyphInstance), glyphs, GL_STREAM_DRAW);
+    setAttrib(LABEL_ATTRIB_RECT, 4, sizeof(GlyphInstance), offsetof(GlyphInstance, rect), 1);
+    setAttrib(LABEL_ATTRIB_UV, 4, sizeof(GlyphInstance), offsetof(GlyphInstance, uv), 1);
+    glVertexAttrib2f(LABEL_ATTRIB_STATE, 0.0f, 0.0f); // at rest, never removed
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_renderer.meshIbo);
+    glDisable(GL_DEPTH_TEST);
+    glDrawElementsInstanced(GL_TRIANGLES, g_renderer.labelIndexCount, GL_UNSIGNED_SHORT,
+        reinterpret_cast<const void*>((g_renderer.bodyIndexCount + g_renderer.stemIndexCount) * sizeof(GLushort)),
+        static_cast<GLsizei>(glyphCount));
+    glEnable(GL_DEPTH_TEST);
+
+    for (GLuint i = 0; i < LABEL_ATTRIB_COUNT; i++) {
+        glVertexAttribDivisor(i, 0);
+        glDisableVertexAttribArray(i);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glUseProgram(0);
+}
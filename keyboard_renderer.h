@@ -0,0 +1,82 @@
+// keyboard_renderer.h
+// Retained-mode renderer for the 3D keyboard. Every key is an instance of one
+// unit keycap + switch mesh; the press animation runs in the vertex shader.
+// Per frame only the press state of keys that changed is uploaded, and the
+// whole board is drawn in three instanced draw calls (bodies, switch stems,
+// then label glyphs from a baked atlas) whatever the key count. When
+// framebuffer objects are available the board is cached offscreen and only
+// the rectangles of changed keys are redrawn.
+//
+// All functions need a current GL context (2.1 with ARB_instanced_arrays, or
+// 3.3) and loadGLFunctions() to have succeeded.
+
+#pragma once
+
+#include "key_state.h"
+#include "keyboard.h"
+#include "switch_profiles.h"
+
+#include <cstddef>
+#include <vector>
+
+// Compiles the keyboard shader. Returns false (after logging) on failure.
+bool initKeyboardRenderer();
+void shutdownKeyboardRenderer();
+
+constexpr float MIN_RENDER_SCALE = 0.25f;
+
+struct KeyboardTargetSettings {
+    float renderScale = 1.0f;       // offscreen pixels per window pixel, MIN_RENDER_SCALE..1
+    int samples = 0;                // MSAA samples wanted, 0 = none
+    std::size_t memoryBudget = 0;   // bytes; samples are halved until the target fits, 0 = no limit
+};
+
+// Sizes the offscreen board to the window's framebuffer. pixelScale is
+// framebuffer pixels per projection unit (2 on a HiDPI display with a
+// window-sized ortho projection). Below a render scale of 1 the board is
+// drawn at that fraction of the window's resolution and stretched to fill
+// it. Without this, or without framebuffer object support, every frame
+// redraws the whole board at full resolution, without MSAA.
+void setKeyboardTarget(int framebufferWidth, int framebufferHeight, float pixelScale,
+    const KeyboardTargetSettings& settings = KeyboardTargetSettings());
+
+// The offscreen target setKeyboardTarget() ended up with; all zero when the
+// board draws straight to the window.
+struct KeyboardTargetInfo {
+    int width = 0;
+    int height = 0;
+    int samples = 0;                // 0 = single-sampled
+    std::size_t bytes = 0;          // color + depth (+ resolve copy)
+};
+KeyboardTargetInfo getKeyboardTargetInfo();
+
+// Forces the next drawKeyboard() to redraw the whole board (e.g. after the
+// clear color or projection changed).
+void invalidateKeyboard();
+
+// Rebuilds the per-key instance buffer from the layout. Call again whenever
+// keys are added, removed or moved, or a switch profile's look changed; press
+// state alone never needs a rebuild. Each key's housing and stem follow
+// profiles[key.switchId] (profiles[0] if out of range).
+// Keys start out drawn at rest; drawKeyboard() picks up the live state.
+void buildKeyboardMesh(const std::vector<Key>& keys, float keyDepth,
+    const SwitchProfile* profiles, int profileCount);
+
+// Lays out every key's label as glyph quads in one cached buffer. anchors[i]
+// is where key i's label starts when the key is at rest (the x, y that
+// stb_easy_font_print would get). Call after buildKeyboardMesh() on every
+// layout change.
+void buildKeyboardLabels(const std::vector<Key>& keys, const std::vector<glm::vec2>& anchors);
+
+// Uploads pressAnim / keycapRemoved / heat for keys that changed since the last call
+// and draws the board with the current projection and modelview matrices,
+// clearing with the current clear color. With a target set this redraws only
+// what changed and copies the cached board to the window framebuffer.
+void drawKeyboard(const KeyStates& states);
+
+// Draws text (stb_easy_font metrics, '\n' for new lines) straight into the
+// bound framebuffer over whatever drawKeyboard() left there, for diagnostic
+// overlays. Not cached: call it after every drawKeyboard() it should appear on.
+// Glyphs come from the frame's scratch memory, so it never allocates; one
+// overlay per frame, and text past a couple of thousand glyphs is cut.
+void drawOverlayText(const char* text, float x, float y, const glm::vec3& color);
@@ -0,0 +1,135 @@
+// label_atlas.cpp
+// See label_atlas.h. stb_easy_font draws every glyph as axis-aligned quads on
+// integer coordinates, so rasterizing those quads into a bitmap reproduces the
+// old per-frame output pixel for pixel.
+
+#include "label_atlas.h"
+
+#include "stb_easy_font.h"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+constexpr int ATLAS_WIDTH = 256;
+constexpr int ATLAS_PADDING = 1;
+
+// Layout of one stb_easy_font vertex: x, y, z, packed color
+struct EasyFontVertex {
+    float x, y, z;
+    unsigned char color[4];
+};
+
+struct GlyphQuads {
+    EasyFontVertex vertices[256];
+    int quadCount = 0;
+    int minX = 0, minY = 0, maxX = 0, maxY = 0;
+};
+
+static void printGlyph(char c, GlyphQuads& out) {
+    char text[2] = { c, '\0' };
+    out.quadCount = stb_easy_font_print(0.0f, 0.0f, text, nullptr, out.vertices, sizeof(out.vertices));
+    if (out.quadCount == 0)
+        return;
+    out.minX = out.minY = 1 << 20;
+    out.maxX = out.maxY = -(1 << 20);
+    for (int q = 0; q < out.quadCount; q++) {
+        const EasyFontVertex& a = out.vertices[q * 4];
+        const EasyFontVertex& b = out.vertices[q * 4 + 2];
+        out.minX = std::min(out.minX, static_cast<int>(std::min(a.x, b.x)));
+        out.minY = std::min(out.minY, static_cast<int>(std::min(a.y, b.y)));
+        out.maxX = std::max(out.maxX, static_cast<int>(std::max(a.x, b.x)));
+        out.maxY = std::max(out.maxY, static_cast<int>(std::max(a.y, b.y)));
+    }
+}
+
+bool buildGlyphAtlas(GlyphAtlas& atlas) {
+    // First pass: measure and shelf-pack every glyph's ink box.
+    static GlyphQuads quads[GLYPH_LAST - GLYPH_FIRST + 1];
+    int penX = ATLAS_PADDING, penY = ATLAS_PADDING, rowHeight = 0;
+    int cellX[GLYPH_LAST - GLYPH_FIRST + 1] = {};
+    int cellY[GLYPH_LAST - GLYPH_FIRST + 1] = {};
+    for (int c = GLYPH_FIRST; c <= GLYPH_LAST; c++) {
+        int i = c - GLYPH_FIRST;
+        GlyphQuads& g = quads[i];
+        printGlyph(static_cast<char>(c), g);
+        char text[2] = { static_cast<char>(c), '\0' };
+        atlas.glyphs[i] = GlyphInfo();
+        atlas.glyphs[i].advance = static_cast<float>(stb_easy_font_width(text));
+        if (g.quadCount == 0)
+            continue;
+
+        int w = g.maxX - g.minX, h = g.maxY - g.minY;
+        if (penX + w + ATLAS_PADDING > ATLAS_WIDTH) {
+            penX = ATLAS_PADDING;
+            penY += rowHeight + ATLAS_PADDING;
+            rowHeight = 0;
+        }
+        cellX[i] = penX;
+        cellY[i] = penY;
+        penX += w + ATLAS_PADDING;
+        rowHeight = std::max(rowHeight, h);
+    }
+    int height = 1;
+    while (height < penY + rowHeight + ATLAS_PADDING)
+        height *= 2;
+
+    // Second pass: fill the quads and record texture coordinates.
+    std::vector<unsigned char> pixels(static_cast<std::size_t>(ATLAS_WIDTH) * height, 0);
+    for (int i = 0; i <= GLYPH_LAST - GLYPH_FIRST; i++) {
+        const GlyphQuads& g = quads[i];
+        if (g.quadCount == 0)
+            continue;
+        for (int q = 0; q < g.quadCount; q++) {
+            const EasyFontVertex& a = g.vertices[q * 4];
+            const EasyFontVertex& b = g.vertices[q * 4 + 2];
+            int qx0 = static_cast<int>(std::min(a.x, b.x)) - g.minX + cellX[i];
+            int qy0 = static_cast<int>(std::min(a.y, b.y)) - g.minY + cellY[i];
+            int qx1 = static_cast<int>(std::max(a.x, b.x)) - g.minX + cellX[i];
+            int qy1 = static_cast<int>(std::max(a.y, b.y)) - g.minY + cellY[i];
+            for (int y = qy0; y < qy1; y++)
+                std::fill(&pixels[y * ATLAS_WIDTH + qx0], &pixels[y * ATLAS_WIDTH + qx1], 255);
+        }
+
+        GlyphInfo& info = atlas.glyphs[i];
+        info.x0 = static_cast<float>(g.minX);
+        info.y0 = static_cast<float>(g.minY);
+        info.x1 = static_cast<float>(g.maxX);
+        info.y1 = static_cast<float>(g.maxY);
+        info.u0 = static_cast<float>(cellX[i]) / ATLAS_WIDTH;
+        info.v0 = static_cast<float>(cellY[i]) / height;
+        info.u1 = static_cast<float>(cellX[i] + g.maxX - g.minX) / ATLAS_WIDTH;
+        info.v1 = static_cast<float>(cellY[i] + g.maxY - g.minY) / height;
+    }
+
+    glGenTextures(1, &atlas.texture);
+    glBindTexture(GL_TEXTURE_2D, atlas.texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, ATLAS_WIDTH, height, 0, GL_ALPHA, GL_UNSIGNED_BYTE, pixels.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    if (glGetError() != GL_NO_ERROR) {
+        std::cerr << "Error: Could not create the label glyph atlas\n";
+        destroyGlyphAtlas(atlas);
+        return false;
+    }
+    atlas.width = ATLAS_WIDTH;
+    atlas.height = height;
+    return true;
+}
+
+void destroyGlyphAtlas(GlyphAtlas& atlas) {
+    if (atlas.texture)
+        glDeleteTextures(1, &atlas.texture);
+    atlas.texture = 0;
+}
+
+const GlyphInfo& findGlyph(const GlyphAtlas& atlas, char c) {
+    int code = static_cast<unsigned char>(c);
+    if (code < GLYPH_FIRST || code > GLYPH_LAST)
+        code = '?';
+    return atlas.glyphs[code - GLYPH_FIRST];
+}
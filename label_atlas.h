@@ -0,0 +1,35 @@
+// label_atlas.h
+// Bakes the stb_easy_font glyphs (printable ASCII) into one texture once, so
+// key labels can be drawn as textured quads instead of re-running
+// stb_easy_font_print for every key every frame.
+//
+// Requires stb_easy_font.h (ensure "stb_easy_font.h" is in your source folder).
+
+#pragma once
+
+#include "gl_functions.h"
+
+constexpr int GLYPH_FIRST = 32;  // ' '
+constexpr int GLYPH_LAST = 126;  // '~'
+
+struct GlyphInfo {
+    float advance = 0.0f;           // pen movement, as stb_easy_font_print does it
+    float x0 = 0.0f, y0 = 0.0f;     // ink box relative to the pen position
+    float x1 = 0.0f, y1 = 0.0f;
+    float u0 = 0.0f, v0 = 0.0f;     // ink box in the atlas texture
+    float u1 = 0.0f, v1 = 0.0f;
+};
+
+struct GlyphAtlas {
+    GLuint texture = 0;             // GL_ALPHA, nearest filtering
+    int width = 0;
+    int height = 0;
+    GlyphInfo glyphs[GLYPH_LAST - GLYPH_FIRST + 1];
+};
+
+// Needs a current GL context. Returns false (after logging) on failure.
+bool buildGlyphAtlas(GlyphAtlas& atlas);
+void destroyGlyphAtlas(GlyphAtlas& atlas);
+
+// Characters outside the baked range map to '?'.
+const GlyphInfo& findGlyph(const GlyphAtlas& atlas, char c);
@@ -0,0 +1,154 @@
+// latency_stats.cpp
+// See latency_stats.h.
+
+#include "latency_stats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+static LatencyHistogram g_latency[LATENCY_METRIC_COUNT];
+
+static const char* const LATENCY_METRIC_NAMES[LATENCY_METRIC_COUNT] = {
+    "input_to_photon",
+    "input_to_audio"
+};
+
+// Static initialization runs before main(), close enough to process start
+static const std::chrono::steady_clock::time_point g_processStart = std::chrono::steady_clock::now();
+static std::atomic<double> g_startup[STARTUP_MILESTONE_COUNT] = { {-1.0}, {-1.0}, {-1.0}, {-1.0} };
+
+static const char* const STARTUP_MILESTONE_NAMES[STARTUP_MILESTONE_COUNT] = {
+    "startup_window",
+    "startup_audio_ready",
+    "startup_first_frame",
+    "startup_first_click"
+};
+
+int latencyBucket(double seconds) {
+    double micros = seconds * 1e6;
+    if (micros <= 1.0)
+        return 0;
+    int bucket = static_cast<int>(std::ceil(std::log2(micros) * LATENCY_BUCKETS_PER_OCTAVE));
+    return bucket < LATENCY_BUCKET_COUNT ? bucket : LATENCY_BUCKET_COUNT - 1;
+}
+
+double latencyBucketUpperBound(int bucket) {
+    return std::exp2(static_cast<double>(bucket) / LATENCY_BUCKETS_PER_OCTAVE) * 1e-6;
+}
+
+void recordLatency(LatencyMetric metric, double seconds) {
+    if (seconds < 0.0)
+        seconds = 0.0;
+    LatencyHistogram& h = g_latency[metric];
+    h.buckets[latencyBucket(seconds)].fetch_add(1, std::memory_order_relaxed);
+    // Single writer, so a plain compare then store is enough
+    if (seconds > h.max.load(std::memory_order_relaxed))
+        h.max.store(seconds, std::memory_order_relaxed);
+    h.count.fetch_add(1, std::memory_order_release);
+}
+
+LatencySummary summarizeLatency(LatencyMetric metric) {
+    const LatencyHistogram& h = g_latency[metric];
+    LatencySummary s;
+    s.count = h.count.load(std::memory_order_acquire);
+    s.max = h.max.load(std::memory_order_relaxed);
+    if (s.count == 0)
+        return s;
+
+    // Buckets may run slightly ahead of count while the writer is mid-record
+    std::uint32_t p50Rank = (s.count + 1) / 2;
+    std::uint32_t p99Rank = s.count - s.count / 100;
+    std::uint32_t seen = 0;
+    for (int b = 0; b < LATENCY_BUCKET_COUNT; b++) {
+        std::uint32_t n = h.buckets[b].load(std::memory_order_relaxed);
+        if (n == 0)
+            continue;
+        if (seen < p50Rank && seen + n >= p50Rank)
+            s.p50 = latencyBucketUpperBound(b);
+        if (seen < p99Rank && seen + n >= p99Rank)
+            s.p99 = latencyBucketUpperBound(b);
+        seen += n;
+    }
+    // The top bucket's bound can overshoot the largest sample
+    if (s.p50 > s.max)
+        s.p50 = s.max;
+    if (s.p99 > s.max)
+        s.p99 = s.max;
+    return s;
+}
+
+const char* latencyMetricName(LatencyMetric metric) {
+    return LATENCY_METRIC_NAMES[metric];
+}
+
+std::uint32_t latencySampleCount() {
+    std::uint32_t total = 0;
+    for (const LatencyHistogram& h : g_latency)
+        total += h.count.load(std::memory_order_relaxed);
+    return total;
+}
+
+void markStartupMilestone(StartupMilestone milestone) {
+    std::atomic<double>& slot = g_startup[milestone];
+    if (slot.load(std::memory_order_relaxed) >= 0.0)
+        return;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - g_processStart).count();
+    double unset = -1.0;
+    slot.compare_exchange_strong(unset, seconds, std::memory_order_relaxed);
+}
+
+double startupMilestoneSeconds(StartupMilestone milestone) {
+    return g_startup[milestone].load(std::memory_order_relaxed);
+}
+
+// Length of the report after snprintf wrote (or would have written) written
+// more characters at length into a buffer of capacity, truncating at its end
+static std::size_t appendReport(std::size_t capacity, std::size_t length, int written) {
+    if (written < 0 || length >= capacity)
+        return length;
+    return std::min(length + static_cast<std::size_t>(written), capacity - 1);
+}
+
+std::size_t formatLatencyReport(char* out, std::size_t capacity) {
+    if (capacity == 0)
+        return 0;
+    std::size_t length = appendReport(capacity, 0,
+        std::snprintf(out, capacity, "latency (ms)       p50     p99     max"));
+    for (int m = 0; m < LATENCY_METRIC_COUNT; m++) {
+        LatencySummary s = summarizeLatency(static_cast<LatencyMetric>(m));
+        length = appendReport(capacity, length, std::snprintf(out + length, capacity - length,
+            "\n%-16s %7.2f %7.2f %7.2f  (%u)", LATENCY_METRIC_NAMES[m], s.p50 * 1e3, s.p99 * 1e3, s.max * 1e3, s.count));
+    }
+    for (int m = 0; m < STARTUP_MILESTONE_COUNT; m++) {
+        double seconds = startupMilestoneSeconds(static_cast<StartupMilestone>(m));
+        if (seconds < 0.0)
+            continue;
+        length = appendReport(capacity, length, std::snprintf(out + length, capacity - length,
+            "\n%-20s %7.1f", STARTUP_MILESTONE_NAMES[m], seconds * 1e3));
+    }
+    return length;
+}
+
+bool writeLatencyCsv(const std::string& path) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        std::cerr << "Error: Could not write latency report " << path << "\n";
+        return false;
+    }
+    out << "metric,samples,p50_ms,p99_ms,max_ms\n";
+    for (int m = 0; m < LATENCY_METRIC_COUNT; m++) {
+        LatencySummary s = summarizeLatency(static_cast<LatencyMetric>(m));
+        out << LATENCY_METRIC_NAMES[m] << "," << s.count << "," << s.p50 * 1e3 << ","
+            << s.p99 * 1e3 << "," << s.max * 1e3 << "\n";
+    }
+    for (int m = 0; m < STARTUP_MILESTONE_COUNT; m++) {
+        double ms = startupMilestoneSeconds(static_cast<StartupMilestone>(m)) * 1e3;
+        if (ms >= 0.0)
+            out << STARTUP_MILESTONE_NAMES[m] << ",1," << ms << "," << ms << "," << ms << "\n";
+    }
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,83 @@
+// latency_stats.h
+// What the user feels: time from an input callback to the frame that shows
+// it and to the first sample of its click. Each metric is a fixed log-scale
+// histogram written by exactly one thread (relaxed atomics, no locks) and
+// read from any, so recording on the audio thread never waits on the UI.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+enum LatencyMetric {
+    LATENCY_INPUT_TO_PHOTON, // callback entry -> glfwSwapBuffers of the first frame showing it (render thread)
+    LATENCY_INPUT_TO_AUDIO,  // callback entry -> first click sample at the device (audio thread)
+    LATENCY_METRIC_COUNT
+};
+
+// 4 buckets per octave from 1 us up to ~14 s
+constexpr int LATENCY_BUCKETS_PER_OCTAVE = 4;
+constexpr int LATENCY_BUCKET_COUNT = 24 * LATENCY_BUCKETS_PER_OCTAVE;
+
+struct LatencyHistogram {
+    std::atomic<std::uint32_t> buckets[LATENCY_BUCKET_COUNT] = {};
+    std::atomic<std::uint32_t> count{ 0 };
+    std::atomic<double> max{ 0.0 };
+};
+
+struct LatencySummary {
+    std::uint32_t count = 0;
+    double p50 = 0.0;               // seconds, bucket upper bound
+    double p99 = 0.0;
+    double max = 0.0;               // exact
+};
+
+// Log-scale bucket of a duration and the upper bound of a bucket, in
+// seconds. Shared with other histograms of human-scale times (typing_stats.h).
+int latencyBucket(double seconds);
+double latencyBucketUpperBound(int bucket);
+
+// Writer side; call for a given metric from one thread only. Never blocks
+// or allocates.
+void recordLatency(LatencyMetric metric, double seconds);
+
+LatencySummary summarizeLatency(LatencyMetric metric);
+const char* latencyMetricName(LatencyMetric metric);
+
+// Total samples over all metrics, to tell whether a summary went stale.
+std::uint32_t latencySampleCount();
+
+// Multi-line p50 / p99 / max table in milliseconds, for the on-screen
+// overlay, followed by the startup milestones reached. Writes at most
+// capacity bytes including the terminator (LATENCY_REPORT_CAPACITY holds it
+// all) and returns the length written; never allocates, so the render
+// thread can call it every frame.
+constexpr std::size_t LATENCY_REPORT_CAPACITY = 1024;
+std::size_t formatLatencyReport(char* out, std::size_t capacity);
+
+// One row per metric: metric,samples,p50_ms,p99_ms,max_ms, then one per
+// startup milestone reached (samples 1, its time in every column). Returns
+// false (after logging) if the file could not be written.
+bool writeLatencyCsv(const std::string& path);
+
+// -------------------------
+// Startup
+// -------------------------
+// One-off times since the process started, for how long launching takes
+// until the board is usable.
+enum StartupMilestone {
+    STARTUP_WINDOW,         // window and GL context created (main thread)
+    STARTUP_AUDIO_READY,    // patches rendered and the device running (audio init thread)
+    STARTUP_FIRST_FRAME,    // first frame swapped (render thread)
+    STARTUP_FIRST_CLICK,    // first click started playing (audio thread)
+    STARTUP_MILESTONE_COUNT
+};
+
+// Records the milestone now unless it was already reached. Any thread;
+// never blocks or allocates.
+void markStartupMilestone(StartupMilestone milestone);
+
+// Seconds from process start to the milestone, or -1 if not reached yet.
+double startupMilestoneSeconds(StartupMilestone milestone);
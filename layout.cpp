@@ -0,0 +1,505 @@
+// layout.cpp
+// See layout.h. Source format, one directive per line ('#' starts a comment,
+// sizes in pixels unless noted):
+//
+//   title "Advanced 3D Keyboard Simulator"
+//   window fullscreen | window <w> <h>
+//   background <r> <g> <b>
+//   key_size <w> <h>          one key unit
+//   spacing <x> <y>           gap between keys and rows
+//   key_depth <d>
+//   center <w> <h>            center a block of this size in the window
+//   origin <x> <y>            offset of the board origin (after centering)
+//   label center|left <dx> <dy>
+//                             label pen: x = dx (+ width / 2 for center),
+//                             y = height / 2 + dy
+//   type <name>               default KeyType for the keys that follow
+//   switch <name>             default switch profile for the keys that follow
+//   row [indent]              start the next row, indent pixels in
+//   at <x> <y>                move the pen; 'row' returns to this x
+//   gap <px>                  advance the pen
+//   key <label> <code> [width] [type=..] [switch=..] [height=..] [label_dx=..] [label_dy=..] [alias=<code>]...
+//                             width/height in key units, code a GLFW_KEY_
+//                             name without the prefix (or - for none); every
+//                             alias is one more code driving the same key
+//   keys <code> <code> ...    unit keys labelled with their code names
+
+#include "layout.h"
+
+#include "keyboard.h"
+#include "switch_profiles.h"
+
+#include <GLFW/glfw3.h>
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char LAYOUT_MAGIC[4] = { 'Q', 'G', 'L', 'B' };
+
+// -------------------------
+// Name Tables
+// -------------------------
+struct NamedKey {
+    const char* name;
+    int code;
+};
+
+#define QG_KEY(name) { #name, GLFW_KEY_##name }
+static const NamedKey NAMED_KEYS[] = {
+    QG_KEY(SPACE), QG_KEY(APOSTROPHE), QG_KEY(COMMA), QG_KEY(MINUS), QG_KEY(PERIOD),
+    QG_KEY(SLASH), QG_KEY(SEMICOLON), QG_KEY(EQUAL), QG_KEY(LEFT_BRACKET),
+    QG_KEY(BACKSLASH), QG_KEY(RIGHT_BRACKET), QG_KEY(GRAVE_ACCENT),
+    QG_KEY(ESCAPE), QG_KEY(ENTER), QG_KEY(TAB), QG_KEY(BACKSPACE), QG_KEY(INSERT),
+    QG_KEY(DELETE), QG_KEY(RIGHT), QG_KEY(LEFT), QG_KEY(DOWN), QG_KEY(UP),
+    QG_KEY(PAGE_UP), QG_KEY(PAGE_DOWN), QG_KEY(HOME), QG_KEY(END),
+    QG_KEY(CAPS_LOCK), QG_KEY(SCROLL_LOCK), QG_KEY(NUM_LOCK), QG_KEY(PRINT_SCREEN),
+    QG_KEY(PAUSE), QG_KEY(KP_DECIMAL), QG_KEY(KP_DIVIDE), QG_KEY(KP_MULTIPLY),
+    QG_KEY(KP_SUBTRACT), QG_KEY(KP_ADD), QG_KEY(KP_ENTER), QG_KEY(KP_EQUAL),
+    QG_KEY(LEFT_SHIFT), QG_KEY(LEFT_CONTROL), QG_KEY(LEFT_ALT), QG_KEY(LEFT_SUPER),
+    QG_KEY(RIGHT_SHIFT), QG_KEY(RIGHT_CONTROL), QG_KEY(RIGHT_ALT), QG_KEY(RIGHT_SUPER),
+    QG_KEY(MENU)
+};
+#undef QG_KEY
+
+// GLFW key code for a name: A-Z, 0-9, F1-F25, KP_0-KP_9 or NAMED_KEYS; -1 if unknown.
+static int findKeyCode(const std::string& name) {
+    if (name.size() == 1 && name[0] >= 'A' && name[0] <= 'Z')
+        return GLFW_KEY_A + (name[0] - 'A');
+    if (name.size() == 1 && name[0] >= '0' && name[0] <= '9')
+        return GLFW_KEY_0 + (name[0] - '0');
+    if (name.size() >= 2 && name[0] == 'F' && std::isdigit(static_cast<unsigned char>(name[1]))) {
+        int n = std::atoi(name.c_str() + 1);
+        if (n >= 1 && n <= 25)
+            return GLFW_KEY_F1 + (n - 1);
+    }
+    if (name.size() == 4 && name.compare(0, 3, "KP_") == 0 && name[3] >= '0' && name[3] <= '9')
+        return GLFW_KEY_KP_0 + (name[3] - '0');
+    for (const NamedKey& k : NAMED_KEYS) {
+        if (name == k.name)
+            return k.code;
+    }
+    return -1;
+}
+
+static const char* const KEY_TYPE_NAMES[] = {
+    "alphanum", "function", "modifier", "navigation", "arrow", "numpad", "background"
+};
+
+static int findKeyType(const std::string& name) {
+    for (int i = 0; i < static_cast<int>(sizeof(KEY_TYPE_NAMES) / sizeof(KEY_TYPE_NAMES[0])); i++) {
+        if (name == KEY_TYPE_NAMES[i])
+            return i;
+    }
+    return -1;
+}
+
+// -------------------------
+// Compiler
+// -------------------------
+// Splits a line into words; "double quotes" group words, '#' ends the line.
+static std::vector<std::string> tokenize(const std::string& line) {
+    std::vector<std::string> tokens;
+    std::size_t i = 0;
+    while (i < line.size()) {
+        char c = line[i];
+        if (c == ' ' || c == '\t' || c == '\r') {
+            i++;
+        }
+        else if (c == '#') {
+            break;
+        }
+        else if (c == '"') {
+            std::size_t end = line.find('"', i + 1);
+            if (end == std::string::npos)
+                end = line.size();
+            tokens.push_back(line.substr(i + 1, end - i - 1));
+            i = end + 1;
+        }
+        else {
+            std::size_t end = line.find_first_of(" \t\r", i);
+            if (end == std::string::npos)
+                end = line.size();
+            tokens.push_back(line.substr(i, end - i));
+            i = end;
+        }
+    }
+    return tokens;
+}
+
+static bool parseFloat(const std::string& text, float& value) {
+    char* end = nullptr;
+    value = std::strtof(text.c_str(), &end);
+    return end != text.c_str() && *end == '\0';
+}
+
+struct LayoutCompiler {
+    LayoutHeader header = {};
+    std::vector<LayoutKeyRecord> keys;
+    std::vector<LayoutKeyAlias> aliases;
+    std::string strings;
+
+    float keyWidth = 60.0f, keyHeight = 60.0f;
+    float spacingX = 6.0f, spacingY = 6.0f;
+    bool labelCentered = true;
+    float labelDx = -8.0f, labelDy = -8.0f;
+    int defaultType = static_cast<int>(KeyType::ALPHANUM);
+    int defaultSwitch = CLICK_ULTRA_CRISP;
+
+    float penX = 0.0f, penY = 0.0f;
+    float rowX = 0.0f;
+    bool anyRow = false;
+
+    std::uint32_t addString(const std::string& s) {
+        std::uint32_t offset = static_cast<std::uint32_t>(strings.size());
+        strings += s;
+        return offset;
+    }
+
+    bool addKey(const std::string& label, const std::string& code, const std::vector<std::string>& options,
+        std::string& error)
+    {
+        LayoutKeyRecord k = {};
+        float widthUnits = 1.0f, heightUnits = 1.0f;
+        float dx = 0.0f, dy = 0.0f;
+        int type = defaultType, switchId = defaultSwitch;
+        std::uint32_t keyIndex = static_cast<std::uint32_t>(keys.size());
+
+        int glfwKey = -1;
+        if (code != "-") {
+            glfwKey = findKeyCode(code);
+            if (glfwKey < 0) {
+                error = "unknown key code '" + code + "'";
+                return false;
+            }
+        }
+        for (const std::string& opt : options) {
+            std::size_t eq = opt.find('=');
+            std::string name = opt.substr(0, eq);
+            std::string value = eq == std::string::npos ? std::string() : opt.substr(eq + 1);
+            bool ok = true;
+            if (eq == std::string::npos)
+                ok = parseFloat(opt, widthUnits);
+            else if (name == "height")
+                ok = parseFloat(value, heightUnits);
+            else if (name == "label_dx")
+                ok = parseFloat(value, dx);
+            else if (name == "label_dy")
+                ok = parseFloat(value, dy);
+            else if (name == "type")
+                ok = (type = findKeyType(value)) >= 0;
+            else if (name == "switch")
+                ok = (switchId = findSwitchProfile(value.c_str())) >= 0;
+            else if (name == "alias") {
+                int aliasKey = findKeyCode(value);
+                if ((ok = aliasKey >= 0))
+                    aliases.push_back({ keyIndex, static_cast<std::int16_t>(aliasKey), 0 });
+            }
+            else
+                ok = false;
+            if (!ok) {
+                error = "bad key option '" + opt + "'";
+                return false;
+            }
+        }
+
+        k.x = penX;
+        k.y = penY;
+        k.width = keyWidth * widthUnits;
+        k.height = keyHeight * heightUnits;
+        k.labelX = (labelCentered ? k.width * 0.5f : 0.0f) + labelDx + dx;
+        k.labelY = k.height * 0.5f + labelDy + dy;
+        k.glfwKey = static_cast<std::int16_t>(glfwKey);
+        k.type = static_cast<std::uint8_t>(type);
+        k.switchId = static_cast<std::uint8_t>(switchId);
+        k.labelOffset = addString(label);
+        k.labelLength = static_cast<std::uint32_t>(label.size());
+        keys.push_back(k);
+        penX += k.width + spacingX;
+        return true;
+    }
+
+    bool directive(const std::vector<std::string>& t, std::string& error) {
+        const std::string& d = t[0];
+        auto floats = [&](std::size_t count, float* out) {
+            if (t.size() != count + 1)
+                return false;
+            for (std::size_t i = 0; i < count; i++) {
+                if (!parseFloat(t[i + 1], out[i]))
+                    return false;
+            }
+            return true;
+        };
+        float v[3];
+
+        if (d == "title" && t.size() == 2) {
+            header.titleOffset = addString(t[1]);
+            header.titleLength = static_cast<std::uint32_t>(t[1].size());
+        }
+        else if (d == "window" && t.size() == 2 && t[1] == "fullscreen") {
+            header.windowWidth = header.windowHeight = 0;
+        }
+        else if (d == "window" && floats(2, v)) {
+            header.windowWidth = static_cast<std::int32_t>(v[0]);
+            header.windowHeight = static_cast<std::int32_t>(v[1]);
+        }
+        else if (d == "background" && floats(3, v)) {
+            std::memcpy(header.background, v, sizeof(header.background));
+        }
+        else if (d == "key_size" && floats(2, v)) {
+            keyWidth = v[0];
+            keyHeight = v[1];
+        }
+        else if (d == "spacing" && floats(2, v)) {
+            spacingX = v[0];
+            spacingY = v[1];
+        }
+        else if (d == "key_depth" && floats(1, v)) {
+            header.keyDepth = v[0];
+        }
+        else if (d == "center" && floats(2, v)) {
+            header.centerWidth = v[0];
+            header.centerHeight = v[1];
+        }
+        else if (d == "origin" && floats(2, v)) {
+            header.originX = v[0];
+            header.originY = v[1];
+        }
+        else if (d == "label" && t.size() == 4 && (t[1] == "center" || t[1] == "left")
+            && parseFloat(t[2], labelDx) && parseFloat(t[3], labelDy)) {
+            labelCentered = t[1] == "center";
+        }
+        else if (d == "type" && t.size() == 2) {
+            if ((defaultType = findKeyType(t[1])) < 0) {
+                error = "unknown key type '" + t[1] + "'";
+                return false;
+            }
+        }
+        else if (d == "switch" && t.size() == 2) {
+            if ((defaultSwitch = findSwitchProfile(t[1].c_str())) < 0) {
+                error = "unknown switch '" + t[1] + "'";
+                return false;
+            }
+        }
+        else if (d == "row" && (t.size() == 1 || floats(1, v))) {
+            if (anyRow)
+                penY += keyHeight + spacingY;
+            anyRow = true;
+            penX = rowX + (t.size() == 2 ? v[0] : 0.0f);
+        }
+        else if (d == "at" && floats(2, v)) {
+            penX = rowX = v[0];
+            penY = v[1];
+            anyRow = true;
+        }
+        else if (d == "gap" && floats(1, v)) {
+            penX += v[0];
+        }
+        else if (d == "key" && t.size() >= 3) {
+            return addKey(t[1], t[2], std::vector<std::string>(t.begin() + 3, t.end()), error);
+        }
+        else if (d == "keys" && t.size() >= 2) {
+            for (std::size_t i = 1; i < t.size(); i++) {
+                if (!addKey(t[i], t[i], {}, error))
+                    return false;
+            }
+        }
+        else {
+            error = "cannot parse '" + d + "' directive";
+            return false;
+        }
+        return true;
+    }
+};
+
+bool compileLayout(const std::string& source, std::vector<char>& blob, std::string& error) {
+    LayoutCompiler c;
+    std::memcpy(c.header.magic, LAYOUT_MAGIC, sizeof(LAYOUT_MAGIC));
+    c.header.version = LAYOUT_BLOB_VERSION;
+    c.header.keyDepth = 18.0f;
+
+    std::istringstream in(source);
+    std::string line;
+    for (int lineNumber = 1; std::getline(in, line); lineNumber++) {
+        std::vector<std::string> tokens = tokenize(line);
+        if (tokens.empty())
+            continue;
+        std::string message;
+        if (!c.directive(tokens, message)) {
+            error = std::to_string(lineNumber) + ": " + message;
+            return false;
+        }
+    }
+    if (c.keys.empty()) {
+        error = "0: layout has no keys";
+        return false;
+    }
+
+    c.header.keyCount = static_cast<std::uint32_t>(c.keys.size());
+    c.header.aliasCount = static_cast<std::uint32_t>(c.aliases.size());
+    c.header.stringBytes = static_cast<std::uint32_t>(c.strings.size());
+    std::size_t keyBytes = c.keys.size() * sizeof(LayoutKeyRecord);
+    std::size_t aliasBytes = c.aliases.size() * sizeof(LayoutKeyAlias);
+    blob.resize(sizeof(LayoutHeader) + keyBytes + aliasBytes + c.strings.size());
+    std::size_t at = 0;
+    auto append = [&](const void* data, std::size_t bytes) {
+        if (bytes)
+            std::memcpy(blob.data() + at, data, bytes);
+        at += bytes;
+    };
+    append(&c.header, sizeof(LayoutHeader));
+    append(c.keys.data(), keyBytes);
+    append(c.aliases.data(), aliasBytes);
+    append(c.strings.data(), c.strings.size());
+    return true;
+}
+
+// -------------------------
+// Cache File
+// -------------------------
+static void unmapLayout(Layout& layout) {
+    if (!layout.mapping)
+        return;
+#if defined(_WIN32)
+    UnmapViewOfFile(layout.mapping);
+#else
+    munmap(layout.mapping, layout.mappingSize);
+#endif
+    layout.mapping = nullptr;
+    layout.mappingSize = 0;
+}
+
+static bool mapFile(const std::string& path, Layout& layout) {
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping)
+        return false;
+    layout.mapping = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    layout.mappingSize = static_cast<std::size_t>(size.QuadPart);
+    return layout.mapping != nullptr;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+        data = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+    layout.mapping = data;
+    layout.mappingSize = static_cast<std::size_t>(st.st_size);
+    return true;
+#endif
+}
+
+// Points the layout at a blob after checking it is complete and current.
+static bool viewBlob(Layout& layout, const char* data, std::size_t size,
+    std::uint64_t sourceSize, std::int64_t sourceTime)
+{
+    if (size < sizeof(LayoutHeader))
+        return false;
+    const LayoutHeader* h = reinterpret_cast<const LayoutHeader*>(data);
+    if (std::memcmp(h->magic, LAYOUT_MAGIC, sizeof(LAYOUT_MAGIC)) != 0 || h->version != LAYOUT_BLOB_VERSION
+        || h->sourceSize != sourceSize || h->sourceTime != sourceTime)
+        return false;
+    std::size_t keyBytes = std::size_t(h->keyCount) * sizeof(LayoutKeyRecord);
+    std::size_t aliasBytes = std::size_t(h->aliasCount) * sizeof(LayoutKeyAlias);
+    if (size != sizeof(LayoutHeader) + keyBytes + aliasBytes + h->stringBytes)
+        return false;
+    const LayoutKeyAlias* aliases = reinterpret_cast<const LayoutKeyAlias*>(data + sizeof(LayoutHeader) + keyBytes);
+    for (std::uint32_t a = 0; a < h->aliasCount; a++) {
+        if (aliases[a].keyIndex >= h->keyCount)
+            return false;
+    }
+
+    layout.header = h;
+    layout.keys = reinterpret_cast<const LayoutKeyRecord*>(data + sizeof(LayoutHeader));
+    layout.aliases = aliases;
+    layout.strings = data + sizeof(LayoutHeader) + keyBytes + aliasBytes;
+    return true;
+}
+
+bool loadLayout(const std::string& path, Layout& layout) {
+    closeLayout(layout);
+    std::error_code ec;
+    std::uint64_t sourceSize = std::filesystem::file_size(path, ec);
+    if (ec) {
+        std::cerr << "Error: Could not open layout " << path << "\n";
+        return false;
+    }
+    std::int64_t sourceTime = static_cast<std::int64_t>(
+        std::filesystem::last_write_time(path, ec).time_since_epoch().count());
+
+    // Fast path: an up-to-date cache
+    std::string cachePath = path + ".bin";
+    if (mapFile(cachePath, layout)) {
+        if (viewBlob(layout, static_cast<const char*>(layout.mapping), layout.mappingSize, sourceSize, sourceTime))
+            return true;
+        unmapLayout(layout);
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    std::string source((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::string error;
+    if (!in || !compileLayout(source, layout.owned, error)) {
+        std::cerr << "Error: " << path << ":" << (error.empty() ? "0: could not read" : error) << "\n";
+        return false;
+    }
+    LayoutHeader* h = reinterpret_cast<LayoutHeader*>(layout.owned.data());
+    h->sourceSize = sourceSize;
+    h->sourceTime = sourceTime;
+
+    // Write the cache through a temporary so a concurrent start never maps
+    // half a file. A read-only install just keeps the compiled copy.
+    std::string tempPath = cachePath + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        out.write(layout.owned.data(), static_cast<std::streamsize>(layout.owned.size()));
+    }
+    std::filesystem::rename(tempPath, cachePath, ec);
+    if (ec)
+        std::filesystem::remove(tempPath, ec);
+
+    return viewBlob(layout, layout.owned.data(), layout.owned.size(), sourceSize, sourceTime);
+}
+
+void closeLayout(Layout& layout) {
+    unmapLayout(layout);
+    layout.owned.clear();
+    layout.header = nullptr;
+    layout.keys = nullptr;
+    layout.aliases = nullptr;
+    layout.strings = nullptr;
+}
+
+std::string layoutString(const Layout& layout, std::uint32_t offset, std::uint32_t length) {
+    if (!layout.header || std::uint64_t(offset) + length > layout.header->stringBytes)
+        return std::string();
+    return std::string(layout.strings + offset, length);
+}
@@ -0,0 +1,79 @@
+// layout.h
+// Keyboard layouts as data. A text description (see layouts/*.layout) is
+// compiled once into a compact binary blob that is cached next to the source
+// as "<file>.bin" and memory-mapped on later starts, so startup never reparses
+// an unchanged layout.
+//
+// Blob: LayoutHeader, keyCount LayoutKeyRecords, aliasCount LayoutKeyAliases,
+// then the string table.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+constexpr std::uint32_t LAYOUT_BLOB_VERSION = 2;
+
+struct LayoutHeader {
+    char magic[4];                  // "QGLB"
+    std::uint32_t version;          // LAYOUT_BLOB_VERSION
+    std::uint64_t sourceSize;       // source file the blob was compiled from,
+    std::int64_t sourceTime;        // used to detect a stale cache
+    std::uint32_t keyCount;
+    std::uint32_t stringBytes;
+    std::uint32_t titleOffset;      // window title in the string table
+    std::uint32_t titleLength;
+    std::int32_t windowWidth;       // 0 x 0 = fullscreen on the primary monitor
+    std::int32_t windowHeight;
+    float background[3];            // clear color
+    float keyDepth;
+    float centerWidth;              // > 0: center a block this size in the window
+    float centerHeight;
+    float originX;                  // then offset the board origin by this
+    float originY;
+    std::uint32_t aliasCount;
+    std::uint32_t reserved;
+};
+
+struct LayoutKeyRecord {
+    float x, y;                     // top-left, relative to the board origin
+    float width, height;
+    float labelX, labelY;           // label pen position relative to the key's top-left
+    std::int16_t glfwKey;           // -1 if no key code drives this key; more in the alias table
+    std::uint8_t type;              // KeyType
+    std::uint8_t switchId;          // index into the switch profile table
+    std::uint32_t labelOffset;      // in the string table
+    std::uint32_t labelLength;
+};
+
+// A further key code driving a key, in key order
+struct LayoutKeyAlias {
+    std::uint32_t keyIndex;
+    std::int16_t glfwKey;
+    std::int16_t reserved;
+};
+
+// A loaded layout. The pointers view either a memory-mapped cache file or
+// the blob held in `owned` when the cache could not be written.
+struct Layout {
+    const LayoutHeader* header = nullptr;
+    const LayoutKeyRecord* keys = nullptr;
+    const LayoutKeyAlias* aliases = nullptr;
+    const char* strings = nullptr;
+
+    std::vector<char> owned;
+    void* mapping = nullptr;
+    std::size_t mappingSize = 0;
+};
+
+// Loads path, preferring an up-to-date "<path>.bin" cache and (re)writing it
+// otherwise. Returns false after logging an error with file and line.
+bool loadLayout(const std::string& path, Layout& layout);
+void closeLayout(Layout& layout);
+
+// Compiles layout source text into a blob. On failure returns false and
+// sets error to "<line>: <message>".
+bool compileLayout(const std::string& source, std::vector<char>& blob, std::string& error);
+
+std::string layoutString(const Layout& layout, std::uint32_t offset, std::uint32_t length);
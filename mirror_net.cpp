@@ -0,0 +1,363 @@
+// mirror_net.cpp
+// See mirror_net.h.
+
+#include "mirror_net.h"
+
+#include "spsc_queue.h"
+
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <system_error>
+#include <thread>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+using SocketHandle = SOCKET;
+static const SocketHandle NO_SOCKET = INVALID_SOCKET;
+static void closeSocket(SocketHandle s) { closesocket(s); }
+#else
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+using SocketHandle = int;
+static const SocketHandle NO_SOCKET = -1;
+static void closeSocket(SocketHandle s) { close(s); }
+#endif
+
+// -------------------------
+// Constants & State
+// -------------------------
+constexpr double MIRROR_KEEPALIVE_INTERVAL = 0.5; // seconds between packets when nothing changes
+constexpr double MIRROR_PEER_TIMEOUT = 2.0;       // silence after which a board's keys are released
+constexpr int MIRROR_MAX_PEERS = 64;
+constexpr std::size_t MIRROR_QUEUE_CAPACITY = 128;
+constexpr int MIRROR_RECEIVE_TIMEOUT_MS = 100;    // how often the receiver checks for close
+constexpr std::size_t MIRROR_MAX_PACKET = sizeof(MirrorPacketHeader) + 2 * MIRROR_MAX_WORDS * sizeof(std::uint64_t);
+
+// One decoded packet, receiver thread -> main thread
+struct MirrorUpdate {
+    std::uint32_t boardId = 0;
+    std::uint32_t sequence = 0;
+    int wordCount = 0;
+    std::uint64_t held[MIRROR_MAX_WORDS];
+    std::uint64_t changed[MIRROR_MAX_WORDS];
+};
+
+// A remote board as the main thread last saw it
+struct MirrorPeer {
+    bool active = false;
+    std::uint32_t boardId = 0;
+    std::uint32_t sequence = 0;
+    double lastHeard = 0.0;
+    std::uint64_t held[MIRROR_MAX_WORDS] = {};
+};
+
+struct MirrorSender {
+    SocketHandle socket = NO_SOCKET;
+    sockaddr_storage address = {};
+    socklen_t addressLength = 0;
+    std::uint32_t boardId = 0;
+    std::uint32_t sequence = 0;
+    double lastSendTime = -1.0;
+    std::uint64_t lastHeld[MIRROR_MAX_WORDS] = {};
+};
+
+struct MirrorReceiver {
+    SocketHandle socket = NO_SOCKET;
+    std::thread thread;
+    std::atomic<bool> running{ false };
+    MirrorWake wake = nullptr;
+    SpscQueue<MirrorUpdate, MIRROR_QUEUE_CAPACITY> updates;
+};
+
+static MirrorSender g_mirrorSender;
+static MirrorReceiver g_mirrorReceiver;
+static MirrorPeer g_mirrorPeers[MIRROR_MAX_PEERS]; // main thread
+
+// -------------------------
+// Sockets
+// -------------------------
+static bool startSockets() {
+#if defined(_WIN32)
+    static bool started = false;
+    if (!started) {
+        WSADATA data;
+        if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+            std::cerr << "Error: Could not start Winsock\n";
+            return false;
+        }
+        started = true;
+    }
+#endif
+    return true;
+}
+
+static void setNonBlocking(SocketHandle s) {
+#if defined(_WIN32)
+    u_long on = 1;
+    ioctlsocket(s, FIONBIO, &on);
+#else
+    fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+#endif
+}
+
+static void setReceiveTimeout(SocketHandle s, int milliseconds) {
+#if defined(_WIN32)
+    DWORD timeout = static_cast<DWORD>(milliseconds);
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+#else
+    timeval timeout = { milliseconds / 1000, (milliseconds % 1000) * 1000 };
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+#endif
+}
+
+// -------------------------
+// Sending
+// -------------------------
+bool openMirrorSender(const std::string& target) {
+    closeMirrorSender();
+    if (!startSockets())
+        return false;
+
+    std::string host = target;
+    std::string port = std::to_string(DEFAULT_MIRROR_PORT);
+    std::size_t colon = target.rfind(':');
+    if (colon != std::string::npos) {
+        host = target.substr(0, colon);
+        port = target.substr(colon + 1);
+    }
+    addrinfo hints = {};
+    hints.ai_family = AF_INET; // what receivers listen on; broadcast has no IPv6 form either
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &found) != 0 || !found) {
+        std::cerr << "Error: Could not resolve mirror target " << target << " to an IPv4 address\n";
+        return false;
+    }
+    SocketHandle s = socket(found->ai_family, found->ai_socktype, found->ai_protocol);
+    if (s == NO_SOCKET) {
+        std::cerr << "Error: Could not open a socket for mirroring\n";
+        freeaddrinfo(found);
+        return false;
+    }
+    int on = 1;
+    setsockopt(s, SOL_SOCKET, SO_BROADCAST, reinterpret_cast<const char*>(&on), sizeof(on));
+    setNonBlocking(s);
+    std::memcpy(&g_mirrorSender.address, found->ai_addr, found->ai_addrlen);
+    g_mirrorSender.addressLength = static_cast<socklen_t>(found->ai_addrlen);
+    freeaddrinfo(found);
+
+    g_mirrorSender.socket = s;
+    g_mirrorSender.boardId = static_cast<std::uint32_t>(std::random_device{}());
+    g_mirrorSender.sequence = 0;
+    g_mirrorSender.lastSendTime = -1.0;
+    std::memset(g_mirrorSender.lastHeld, 0, sizeof(g_mirrorSender.lastHeld));
+    return true;
+}
+
+void closeMirrorSender() {
+    if (g_mirrorSender.socket != NO_SOCKET)
+        closeSocket(g_mirrorSender.socket);
+    g_mirrorSender.socket = NO_SOCKET;
+}
+
+void sendMirrorState(const std::uint64_t* held, const std::uint64_t* changed, int wordCount, double now) {
+    if (g_mirrorSender.socket == NO_SOCKET)
+        return;
+    if (wordCount > MIRROR_MAX_WORDS)
+        wordCount = MIRROR_MAX_WORDS;
+    bool dirty = g_mirrorSender.lastSendTime < 0.0 || now - g_mirrorSender.lastSendTime >= MIRROR_KEEPALIVE_INTERVAL;
+    for (int w = 0; w < wordCount && !dirty; w++)
+        dirty = changed[w] != 0 || held[w] != g_mirrorSender.lastHeld[w];
+    if (!dirty)
+        return;
+
+    unsigned char packet[MIRROR_MAX_PACKET];
+    MirrorPacketHeader header;
+    std::memcpy(header.magic, "QGMR", 4);
+    header.version = static_cast<std::uint16_t>(MIRROR_PROTOCOL_VERSION);
+    header.wordCount = static_cast<std::uint16_t>(wordCount);
+    header.boardId = g_mirrorSender.boardId;
+    header.sequence = ++g_mirrorSender.sequence;
+    std::size_t maskBytes = static_cast<std::size_t>(wordCount) * sizeof(std::uint64_t);
+    std::memcpy(packet, &header, sizeof(header));
+    std::memcpy(packet + sizeof(header), held, maskBytes);
+    std::memcpy(packet + sizeof(header) + maskBytes, changed, maskBytes);
+    sendto(g_mirrorSender.socket, reinterpret_cast<const char*>(packet), static_cast<int>(sizeof(header) + 2 * maskBytes), 0,
+        reinterpret_cast<const sockaddr*>(&g_mirrorSender.address), g_mirrorSender.addressLength);
+
+    std::memcpy(g_mirrorSender.lastHeld, held, maskBytes);
+    g_mirrorSender.lastSendTime = now;
+}
+
+// -------------------------
+// Receiving
+// -------------------------
+static bool decodePacket(const unsigned char* data, std::size_t size, MirrorUpdate& update) {
+    MirrorPacketHeader header;
+    if (size < sizeof(header))
+        return false;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, "QGMR", 4) != 0 || header.version != MIRROR_PROTOCOL_VERSION
+        || header.wordCount > MIRROR_MAX_WORDS)
+        return false;
+    std::size_t maskBytes = header.wordCount * sizeof(std::uint64_t);
+    if (size != sizeof(header) + 2 * maskBytes)
+        return false;
+    update.boardId = header.boardId;
+    update.sequence = header.sequence;
+    update.wordCount = header.wordCount;
+    std::memcpy(update.held, data + sizeof(header), maskBytes);
+    std::memcpy(update.changed, data + sizeof(header) + maskBytes, maskBytes);
+    return true;
+}
+
+static void receiveLoop() {
+    unsigned char packet[MIRROR_MAX_PACKET + 1]; // one spare byte catches oversized packets
+    MirrorUpdate update;
+    while (g_mirrorReceiver.running.load(std::memory_order_acquire)) {
+        auto received = recv(g_mirrorReceiver.socket, reinterpret_cast<char*>(packet), sizeof(packet), 0);
+        if (received <= 0)
+            continue; // timeout: check whether to stop
+        if (!decodePacket(packet, static_cast<std::size_t>(received), update))
+            continue;
+        if (g_mirrorReceiver.updates.push(update) && g_mirrorReceiver.wake)
+            g_mirrorReceiver.wake();
+    }
+}
+
+bool openMirrorReceiver(std::uint16_t port, MirrorWake wake) {
+    closeMirrorReceiver();
+    if (!startSockets())
+        return false;
+    SocketHandle s = socket(AF_INET, SOCK_DGRAM, 0);
+    if (s == NO_SOCKET) {
+        std::cerr << "Error: Could not open a socket for mirroring\n";
+        return false;
+    }
+    int on = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&on), sizeof(on));
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(s, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        std::cerr << "Error: Could not listen for mirrored boards on port " << port << "\n";
+        closeSocket(s);
+        return false;
+    }
+    setReceiveTimeout(s, MIRROR_RECEIVE_TIMEOUT_MS);
+
+    g_mirrorReceiver.socket = s;
+    g_mirrorReceiver.wake = wake;
+    g_mirrorReceiver.running.store(true, std::memory_order_release);
+    try {
+        g_mirrorReceiver.thread = std::thread(receiveLoop);
+    }
+    catch (const std::system_error&) {
+        std::cerr << "Error: Failed to start the mirror receiver\n";
+        g_mirrorReceiver.running.store(false, std::memory_order_release);
+        closeSocket(s);
+        g_mirrorReceiver.socket = NO_SOCKET;
+        return false;
+    }
+    return true;
+}
+
+void closeMirrorReceiver() {
+    if (!g_mirrorReceiver.thread.joinable())
+        return;
+    g_mirrorReceiver.running.store(false, std::memory_order_release);
+    g_mirrorReceiver.thread.join();
+    closeSocket(g_mirrorReceiver.socket);
+    g_mirrorReceiver.socket = NO_SOCKET;
+    MirrorUpdate stale;
+    while (g_mirrorReceiver.updates.pop(stale)) {
+    }
+}
+
+// -------------------------
+// Applying Updates (main thread)
+// -------------------------
+static void forEachBit(std::uint64_t bits, int word, int keyCount, MirrorKeyHandler handler, bool pressed) {
+    for (int b = 0; bits; b++, bits >>= 1) {
+        int index = word * 64 + b;
+        if ((bits & 1) && index < keyCount)
+            handler(index, pressed);
+    }
+}
+
+static MirrorPeer* findPeer(std::uint32_t boardId) {
+    MirrorPeer* free = nullptr;
+    for (MirrorPeer& peer : g_mirrorPeers) {
+        if (peer.active && peer.boardId == boardId)
+            return &peer;
+        if (!peer.active && !free)
+            free = &peer;
+    }
+    if (free) {
+        *free = MirrorPeer();
+        free->active = true;
+        free->boardId = boardId;
+    }
+    return free; // nullptr: too many boards, ignore this one
+}
+
+static void applyUpdate(const MirrorUpdate& update, MirrorKeyHandler handler, int keyCount, double now) {
+    if (g_mirrorSender.socket != NO_SOCKET && update.boardId == g_mirrorSender.boardId)
+        return; // our own packet, back from a broadcast to our own port
+    MirrorPeer* peer = findPeer(update.boardId);
+    if (!peer)
+        return;
+    bool known = peer->sequence != 0;
+    std::int32_t ahead = static_cast<std::int32_t>(update.sequence - peer->sequence);
+    if (known && ahead <= 0)
+        return; // duplicate or reordered
+    bool contiguous = known && ahead == 1;
+    peer->sequence = update.sequence;
+    peer->lastHeard = now;
+
+    for (int w = 0; w < MIRROR_MAX_WORDS; w++) {
+        std::uint64_t before = peer->held[w];
+        std::uint64_t after = w < update.wordCount ? update.held[w] : 0;
+        forEachBit(before & ~after, w, keyCount, handler, false);
+        forEachBit(after & ~before, w, keyCount, handler, true);
+        // Changed but back where it was: a tap (or a release and re-press)
+        // inside one sender tick. Only trustworthy without a gap.
+        std::uint64_t taps = contiguous && w < update.wordCount ? update.changed[w] & ~(before ^ after) : 0;
+        forEachBit(taps & ~after, w, keyCount, handler, true);
+        forEachBit(taps & ~after, w, keyCount, handler, false);
+        forEachBit(taps & after, w, keyCount, handler, false);
+        forEachBit(taps & after, w, keyCount, handler, true);
+        peer->held[w] = after;
+    }
+}
+
+void dispatchMirrorUpdates(MirrorKeyHandler handler, int keyCount, double now) {
+    MirrorUpdate update;
+    while (g_mirrorReceiver.updates.pop(update))
+        applyUpdate(update, handler, keyCount, now);
+
+    for (MirrorPeer& peer : g_mirrorPeers) {
+        if (!peer.active || now - peer.lastHeard < MIRROR_PEER_TIMEOUT)
+            continue;
+        for (int w = 0; w < MIRROR_MAX_WORDS; w++)
+            forEachBit(peer.held[w], w, keyCount, handler, false);
+        peer = MirrorPeer();
+    }
+}
+
+void resetMirrorPeers() {
+    for (MirrorPeer& peer : g_mirrorPeers)
+        std::memset(peer.held, 0, sizeof(peer.held));
+}
@@ -0,0 +1,69 @@
+// mirror_net.h
+// Ghost-keyboard mirroring over UDP: one instance sends which of its keys
+// are held, others play those presses on their own board as if typed there.
+//
+// Each packet is a MirrorPacketHeader followed by two key-index bitmasks of
+// wordCount 64-bit words each: keys held now, and keys that changed since the
+// sender's previous packet (so a tap that started and ended within one tick
+// still arrives). Senders coalesce everything their main loop handled in one
+// pass into one packet, send only on change plus a keep-alive, and number
+// packets per board; receivers drop stale or reordered ones and, after a
+// gap, work from the held bitmask alone. Fields are in host order; every
+// platform the simulator runs on is little-endian.
+//
+// The receiver thread only decodes and queues. Updates are applied on the
+// main thread through dispatchMirrorUpdates(), which calls back into the
+// board the same way GLFW input does, so mirrored clicks take the path local
+// ones do.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+constexpr std::uint16_t DEFAULT_MIRROR_PORT = 47001;
+constexpr std::uint32_t MIRROR_PROTOCOL_VERSION = 1;
+constexpr int MIRROR_MAX_KEYS = 1024;
+constexpr int MIRROR_MAX_WORDS = MIRROR_MAX_KEYS / 64;
+
+struct MirrorPacketHeader {
+    char magic[4];                  // "QGMR"
+    std::uint16_t version;          // MIRROR_PROTOCOL_VERSION
+    std::uint16_t wordCount;        // 64-bit words per bitmask
+    std::uint32_t boardId;          // random per sending instance
+    std::uint32_t sequence;         // +1 per packet from that board
+};
+
+static_assert(sizeof(MirrorPacketHeader) == 16, "MirrorPacketHeader is sent as is");
+
+// Called on the main thread for every mirrored press or release.
+using MirrorKeyHandler = void (*)(int keyIndex, bool pressed);
+// Called on the receiver thread after queueing, to wake the main loop
+// (glfwPostEmptyEvent).
+using MirrorWake = void (*)();
+
+// Sending, main thread. target is "host:port" or "host" (DEFAULT_MIRROR_PORT),
+// resolved to IPv4 since receivers listen on IPv4; broadcast addresses work,
+// and this board ignores its own packets when they come back. Returns false
+// after logging an error.
+bool openMirrorSender(const std::string& target);
+void closeMirrorSender();
+
+// Sends held/changed (wordCount words each) if anything changed since the
+// last packet or the keep-alive is due at now (seconds, any clock). Never
+// blocks; a full socket buffer drops the packet, and the next one repairs it.
+void sendMirrorState(const std::uint64_t* held, const std::uint64_t* changed, int wordCount, double now);
+
+// Receiving. Starts a thread listening on port. Returns false after logging
+// an error.
+bool openMirrorReceiver(std::uint16_t port, MirrorWake wake);
+void closeMirrorReceiver();
+
+// Main thread: applies every queued update through handler, and releases
+// the keys of boards silent for longer than the keep-alive allows. keyCount
+// bounds the key indices passed on.
+void dispatchMirrorUpdates(MirrorKeyHandler handler, int keyCount, double now);
+
+// Forgets every remote board's held keys without calling the handler, for
+// when the board they index was replaced (layout reload).
+void resetMirrorPeers();
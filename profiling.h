@@ -0,0 +1,15 @@
+// profiling.h
+// Frame and zone markers for the Tracy profiler. They are live in CMake's
+// Profile configuration when QG_TRACY_DIR points at a Tracy checkout (which
+// defines QG_TRACY) and compile to nothing otherwise.
+
+#pragma once
+
+#if defined(QG_TRACY)
+#include <tracy/Tracy.hpp>
+#define QG_FRAME_MARK() FrameMark
+#define QG_ZONE(name) ZoneScopedN(name)
+#else
+#define QG_FRAME_MARK() ((void)0)
+#define QG_ZONE(name) ((void)0)
+#endif
@@ -0,0 +1,267 @@
+// raw_input.cpp
+// See raw_input.h. Who voices a press is settled per key by one counter,
+// presses the listener saw minus presses keyCallback saw. Each side bumps it
+// by one for its own press and voices the press only if the other side was
+// not ahead, so whichever sees a press first plays it and keys the listener
+// cannot see (other devices, unmapped scancodes) still click from the
+// callback.
+
+#include "raw_input.h"
+
+#include "audio_engine.h"
+#include "board.h"
+
+#include <atomic>
+#include <iostream>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#ifndef input_event_sec
+#define input_event_sec time.tv_sec
+#define input_event_usec time.tv_usec
+#endif
+#endif
+
+// -------------------------
+// Listener State
+// -------------------------
+static bool g_rawRunning = false;                  // main thread
+static std::atomic<bool> g_rawFocused{ true };
+static std::vector<std::atomic<int>> g_rawClaims;  // per key: listener presses - callback presses
+static std::vector<std::atomic<double>> g_rawPressTime; // per key: listener's last press, glfwGetTime() timeline
+
+#if defined(__linux__)
+constexpr int EVDEV_SCANCODE_OFFSET = 8;   // X11 and Wayland scancodes are evdev codes + 8
+constexpr int RAW_EVENT_BATCH = 64;
+
+struct RawKey {
+    std::int32_t keyIndex = -1;
+    std::uint16_t patchIndex = 0;
+};
+
+// Listener thread only while it runs
+static RawKey g_rawKeys[KEY_CNT];                  // evdev key code -> board key
+static std::vector<std::uint8_t> g_rawHolds;       // per key: physical keys holding it down
+static std::vector<pollfd> g_rawFds;               // keyboards, then the wake pipe
+static double g_rawClockOffset = 0.0;              // glfwGetTime() - CLOCK_MONOTONIC
+static int g_rawWakePipe[2] = { -1, -1 };
+static std::thread g_rawThread;
+
+// -------------------------
+// Devices
+// -------------------------
+static double monotonicSeconds() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<double>(now.tv_sec) + static_cast<double>(now.tv_nsec) * 1e-9;
+}
+
+static bool testBit(const unsigned long* bits, int bit) {
+    constexpr int WORD_BITS = 8 * sizeof(unsigned long);
+    return (bits[bit / WORD_BITS] >> (bit % WORD_BITS)) & 1UL;
+}
+
+// Keyboards only: anything with letter keys and a space bar
+static int openKeyboard(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+    unsigned long keyBits[KEY_CNT / (8 * sizeof(unsigned long)) + 1] = {};
+    if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keyBits)), keyBits) < 0
+        || !testBit(keyBits, KEY_A) || !testBit(keyBits, KEY_Z) || !testBit(keyBits, KEY_SPACE)) {
+        close(fd);
+        return -1;
+    }
+    int clockId = CLOCK_MONOTONIC; // default is CLOCK_REALTIME, which can jump
+    ioctl(fd, EVIOCSCLOCKID, &clockId);
+    return fd;
+}
+
+static void closeDevices() {
+    for (const pollfd& p : g_rawFds) {
+        if (p.fd >= 0)
+            close(p.fd);
+    }
+    g_rawFds.clear();
+    g_rawWakePipe[0] = g_rawWakePipe[1] = -1;
+}
+
+// -------------------------
+// Listener Thread
+// -------------------------
+static void handleRawKey(const input_event& ev) {
+    if (ev.code >= KEY_CNT || ev.value == 2) // autorepeat makes no click
+        return;
+    const RawKey& key = g_rawKeys[ev.code];
+    if (key.keyIndex < 0)
+        return;
+    if (ev.value == 0) {
+        if (g_rawHolds[key.keyIndex] > 0)
+            g_rawHolds[key.keyIndex]--;
+        return;
+    }
+    if (g_rawHolds[key.keyIndex]++ != 0 || !g_rawFocused.load(std::memory_order_relaxed))
+        return;
+
+    double time = static_cast<double>(ev.input_event_sec) + static_cast<double>(ev.input_event_usec) * 1e-6
+        + g_rawClockOffset;
+    g_rawPressTime[key.keyIndex].store(time, std::memory_order_relaxed);
+    if (g_rawClaims[key.keyIndex].fetch_add(1, std::memory_order_acq_rel) < 0)
+        return; // keyCallback got there first and played it
+
+    KeyEvent e;
+    e.time = time;
+    e.keyIndex = key.keyIndex;
+    e.type = KeyEventType::PRESS;
+    e.patchIndex = key.patchIndex;
+    submitKeyEvent(e, EventProducer::RAW_INPUT);
+}
+
+static void listenLoop() {
+    input_event events[RAW_EVENT_BATCH];
+    nfds_t count = static_cast<nfds_t>(g_rawFds.size());
+    for (;;) {
+        if (poll(g_rawFds.data(), count, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        if (g_rawFds.back().revents)
+            return; // stopRawInput()
+        for (nfds_t i = 0; i + 1 < count; i++) {
+            pollfd& p = g_rawFds[i];
+            if (p.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+                close(p.fd); // unplugged
+                p.fd = -1;    // poll() skips it from now on
+                continue;
+            }
+            if (!(p.revents & POLLIN))
+                continue;
+            ssize_t bytes;
+            while ((bytes = read(p.fd, events, sizeof(events))) > 0) {
+                for (ssize_t n = 0; n < bytes / static_cast<ssize_t>(sizeof(input_event)); n++) {
+                    if (events[n].type == EV_KEY)
+                        handleRawKey(events[n]);
+                }
+            }
+        }
+    }
+}
+#endif
+
+// -------------------------
+// Public Interface
+// -------------------------
+bool startRawInput(GLFWwindow* window) {
+#if defined(__linux__)
+    if (g_rawRunning)
+        return true;
+
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator("/dev/input",
+        std::filesystem::directory_options::skip_permission_denied, ec)) {
+        if (entry.path().filename().string().rfind("event", 0) != 0)
+            continue;
+        int fd = openKeyboard(entry.path().string());
+        if (fd >= 0)
+            g_rawFds.push_back({ fd, POLLIN, 0 });
+    }
+    if (g_rawFds.empty()) {
+        std::cerr << "Warning: Raw input unavailable (no readable keyboard under /dev/input); "
+                     "clicks follow window events\n";
+        return false;
+    }
+    if (pipe2(g_rawWakePipe, O_CLOEXEC) != 0) {
+        std::cerr << "Warning: Raw input unavailable (" << std::strerror(errno) << ")\n";
+        closeDevices();
+        return false;
+    }
+    g_rawFds.push_back({ g_rawWakePipe[0], POLLIN, 0 });
+
+    // The listener's own copy of the key mapping, so a layout reload on the
+    // main thread never races it
+    for (RawKey& key : g_rawKeys)
+        key = RawKey();
+    for (int glfwKey = 0; glfwKey <= GLFW_KEY_LAST; glfwKey++) {
+        int index = glfwKeyToIndex[glfwKey];
+        if (index == UNMAPPED_KEY)
+            continue;
+        int code = glfwGetKeyScancode(glfwKey) - EVDEV_SCANCODE_OFFSET;
+        if (code < 0 || code >= KEY_CNT)
+            continue;
+        g_rawKeys[code].keyIndex = index;
+        g_rawKeys[code].patchIndex = keyboardKeys[index].switchId;
+    }
+    g_rawHolds.assign(keyboardKeys.size(), 0);
+    g_rawClaims = std::vector<std::atomic<int>>(keyboardKeys.size());
+    g_rawPressTime = std::vector<std::atomic<double>>(keyboardKeys.size());
+    for (std::size_t i = 0; i < keyboardKeys.size(); i++) {
+        g_rawClaims[i].store(0, std::memory_order_relaxed);
+        g_rawPressTime[i].store(0.0, std::memory_order_relaxed);
+    }
+    g_rawFocused.store(glfwGetWindowAttrib(window, GLFW_FOCUSED) != 0, std::memory_order_relaxed);
+    g_rawClockOffset = glfwGetTime() - monotonicSeconds();
+
+    try {
+        g_rawThread = std::thread(listenLoop);
+    }
+    catch (const std::system_error&) {
+        std::cerr << "Warning: Raw input unavailable (could not start its thread)\n";
+        close(g_rawWakePipe[1]);
+        closeDevices();
+        return false;
+    }
+    g_rawRunning = true;
+    return true;
+#else
+    (void)window;
+    std::cerr << "Warning: Raw input is only supported on Linux (evdev); clicks follow window events\n";
+    return false;
+#endif
+}
+
+void stopRawInput() {
+#if defined(__linux__)
+    if (!g_rawRunning)
+        return;
+    char wake = 1;
+    if (write(g_rawWakePipe[1], &wake, 1) != 1)
+        std::cerr << "Warning: Could not wake the raw input thread\n";
+    g_rawThread.join();
+    close(g_rawWakePipe[1]);
+    closeDevices();
+    g_rawRunning = false;
+#endif
+}
+
+void setRawInputFocused(bool focused) {
+    if (!g_rawRunning)
+        return;
+    // Neither side counted presses while unfocused, so start even
+    if (focused) {
+        for (auto& claim : g_rawClaims)
+            claim.store(0, std::memory_order_relaxed);
+    }
+    g_rawFocused.store(focused, std::memory_order_relaxed);
+}
+
+bool claimRawPress(int keyIndex, double& pressTime) {
+    if (!g_rawRunning || keyIndex < 0 || keyIndex >= static_cast<int>(g_rawClaims.size()))
+        return false;
+    if (g_rawClaims[keyIndex].fetch_sub(1, std::memory_order_acq_rel) <= 0)
+        return false; // listener has not seen it (yet); keyCallback plays it
+    pressTime = g_rawPressTime[keyIndex].load(std::memory_order_relaxed);
+    return true;
+}
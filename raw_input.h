@@ -0,0 +1,34 @@
+// raw_input.h
+// Key presses straight from the OS, ahead of the window system. A listener
+// thread reads the keyboards' evdev devices (Linux), stamps each press with
+// the kernel's timestamp and voices it at once, instead of waiting for
+// glfwPollEvents to get round to keyCallback. keyCallback still drives the
+// board: it takes the listener's timestamp for the press animation and
+// input-to-photon latency, and skips the click the listener already played.
+//
+// Reading /dev/input needs membership of the input group (or root). Where
+// that fails, and on other platforms, startRawInput() returns false and
+// clicks follow the callbacks as before.
+
+#pragma once
+
+#include <GLFW/glfw3.h>
+
+// Main thread, with the board set up (keyboardKeys, glfwKeyToIndex) and the
+// audio engine running; the listener keeps its own copy of the key mapping.
+// Returns false after logging a warning if no keyboard could be opened.
+bool startRawInput(GLFWwindow* window);
+
+// Joins the listener. Call before changing the board or shutting the audio
+// engine down, then start it again afterwards.
+void stopRawInput();
+
+// Window focus changes. The listener sees every keyboard on the system, so
+// it stays quiet while the presses are meant for another window.
+void setRawInputFocused(bool focused);
+
+// keyCallback, for each press that takes a key's hold count from 0 to 1.
+// Returns true if the listener already played this press, with pressTime
+// set to its OS timestamp on the glfwGetTime() timeline. Either side may
+// see a press first; it is voiced once.
+bool claimRawPress(int keyIndex, double& pressTime);
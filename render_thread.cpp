@@ -0,0 +1,225 @@
+// render_thread.cpp
+// See render_thread.h. Two channels cross from the main thread: the board
+// state as a triple buffer (only the newest matters) and press times as an
+// SPSC queue (every one is a latency sample). Snapshots are numbered as they
+// are published and every press time carries the number of the first
+// snapshot that shows it; the render thread holds a press back until it has
+// acquired that snapshot, so a press is never charged to a frame drawn
+// before it. The mutex and condition variable only put an idle render thread
+// to sleep; board data never goes through them.
+
+#include "render_thread.h"
+
+#include "alloc_counter.h"
+#include "board.h"
+#include "keyboard_renderer.h"
+#include "latency_stats.h"
+#include "profiling.h"
+#include "spsc_queue.h"
+#include "triple_buffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+// -------------------------
+// Shared State
+// -------------------------
+constexpr std::size_t PHOTON_QUEUE_CAPACITY = 256;
+constexpr double OVERLAY_REFRESH_WAIT = 0.1; // seconds; idle wake-up that keeps the overlay current
+// Frames drawn before the allocation check starts, so drivers that build
+// state lazily on the first draws are not charged to a steady frame
+constexpr int ALLOCATION_CHECK_WARMUP_FRAMES = 8;
+
+// What the main thread owns in g_keyStates: every key's current animation.
+// The render thread evaluates it into pressAnim.
+struct BoardSnapshot {
+    std::vector<float> target;
+    std::vector<std::uint8_t> keycapRemoved;
+    std::vector<double> changeTime;
+    std::vector<float> startAnim;
+    std::vector<float> heat;
+    std::uint64_t sequence = 0;    // publishBoardState() count when published
+};
+
+// A press and the snapshot that first shows it
+struct PhotonStamp {
+    double pressTime;
+    std::uint64_t snapshot;
+};
+
+static TripleBuffer<BoardSnapshot> g_boardSnapshots;
+static SpscQueue<PhotonStamp, PHOTON_QUEUE_CAPACITY> g_photonQueue; // press times, main -> render
+static std::uint64_t g_snapshotSequence = 0; // main thread
+
+static GLFWwindow* g_renderWindow = nullptr;
+static RenderSettings g_renderSettings;
+static KeyStates g_renderStates; // render thread only while it runs
+static std::thread g_renderThread;
+static std::atomic<bool> g_renderRunning{ false };
+
+static std::mutex g_wakeMutex;
+static std::condition_variable g_wake;
+static bool g_wakePending = false;
+
+// -------------------------
+// Render Thread
+// -------------------------
+static void renderLoop() {
+    glfwMakeContextCurrent(g_renderWindow);
+    glfwSwapInterval(g_renderSettings.vsync ? 1 : 0);
+
+    PhotonStamp photons[PHOTON_QUEUE_CAPACITY]; // presses not yet on screen
+    std::size_t photonCount = 0;
+    std::uint64_t shownSnapshot = 0;            // the one g_renderStates holds
+    std::uint32_t overlaySamples = 0;
+    char overlayText[LATENCY_REPORT_CAPACITY];
+    int framesDrawn = 0;
+    bool needsDraw = true;
+
+    while (g_renderRunning.load(std::memory_order_acquire)) {
+        double frameStart = glfwGetTime();
+        std::uint64_t frameAllocations = threadAllocationCount();
+
+        while (photonCount < PHOTON_QUEUE_CAPACITY && g_photonQueue.pop(photons[photonCount]))
+            photonCount++;
+        if (g_boardSnapshots.acquire()) {
+            // Retargeted keys animate from their event time, not this frame
+            const BoardSnapshot& board = g_boardSnapshots.front();
+            shownSnapshot = board.sequence;
+            for (std::size_t i = 0; i < g_renderStates.count; i++) {
+                if (board.changeTime[i] == g_renderStates.changeTime[i] && board.target[i] == g_renderStates.target[i])
+                    continue;
+                g_renderStates.target[i] = board.target[i];
+                g_renderStates.changeTime[i] = board.changeTime[i];
+                g_renderStates.startAnim[i] = board.startAnim[i];
+                markKeyAnimating(g_renderStates, i);
+            }
+            std::copy(board.keycapRemoved.begin(), board.keycapRemoved.end(), g_renderStates.keycapRemoved.begin());
+            std::copy(board.heat.begin(), board.heat.end(), g_renderStates.heat.begin());
+            needsDraw = true;
+        }
+
+        bool animating = updateKeyAnimations(g_renderStates, frameStart);
+        if (g_renderSettings.latencyOverlay && latencySampleCount() != overlaySamples)
+            needsDraw = true;
+
+        if (animating || needsDraw) {
+            needsDraw = false;
+            drawKeyboard(g_renderStates);
+            if (g_renderSettings.latencyOverlay) {
+                overlaySamples = latencySampleCount();
+                formatLatencyReport(overlayText, sizeof(overlayText));
+                drawOverlayText(overlayText, 10.0f, 10.0f, g_renderSettings.overlayColor);
+            }
+            glfwSwapBuffers(g_renderWindow);
+            if (framesDrawn < ALLOCATION_CHECK_WARMUP_FRAMES)
+                framesDrawn++;
+            else
+                checkNoAllocations(frameAllocations, "a render thread frame");
+            QG_FRAME_MARK();
+            markStartupMilestone(STARTUP_FIRST_FRAME);
+
+            // Presses whose snapshot this frame drew; later ones wait for theirs
+            double swapTime = glfwGetTime();
+            std::size_t waiting = 0;
+            for (std::size_t i = 0; i < photonCount; i++) {
+                if (photons[i].snapshot <= shownSnapshot)
+                    recordLatency(LATENCY_INPUT_TO_PHOTON, swapTime - photons[i].pressTime);
+                else
+                    photons[waiting++] = photons[i];
+            }
+            photonCount = waiting;
+        }
+
+        if (animating) {
+            // Keep animating; vsync or the frame cap paces it
+            double remaining = frameStart + g_renderSettings.minFrameTime - glfwGetTime();
+            if (remaining > 0.0)
+                std::this_thread::sleep_for(std::chrono::duration<double>(remaining));
+        }
+        else {
+            // Everything settled: sleep until the main thread publishes
+            std::unique_lock<std::mutex> lock(g_wakeMutex);
+            auto woken = [] { return g_wakePending || !g_renderRunning.load(std::memory_order_acquire); };
+            if (g_renderSettings.latencyOverlay)
+                g_wake.wait_for(lock, std::chrono::duration<double>(OVERLAY_REFRESH_WAIT), woken);
+            else
+                g_wake.wait(lock, woken);
+            g_wakePending = false;
+        }
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
+
+// -------------------------
+// Public Interface
+// -------------------------
+bool startRenderThread(GLFWwindow* window, const RenderSettings& settings) {
+    g_renderWindow = window;
+    g_renderSettings = settings;
+    g_renderStates = g_keyStates;
+    g_boardSnapshots.reset({ g_keyStates.target, g_keyStates.keycapRemoved, g_keyStates.changeTime, g_keyStates.startAnim,
+        g_keyStates.heat });
+    PhotonStamp stale;
+    while (g_photonQueue.pop(stale)) {
+    }
+    g_snapshotSequence = 0;
+    g_wakePending = false;
+
+    g_renderRunning.store(true, std::memory_order_release);
+    try {
+        g_renderThread = std::thread(renderLoop);
+    }
+    catch (const std::system_error&) {
+        std::cerr << "Error: Failed to start the render thread\n";
+        g_renderRunning.store(false, std::memory_order_release);
+        return false;
+    }
+    return true;
+}
+
+void stopRenderThread() {
+    if (!g_renderThread.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(g_wakeMutex);
+        g_renderRunning.store(false, std::memory_order_release);
+    }
+    g_wake.notify_one();
+    g_renderThread.join();
+}
+
+void publishBoardState() {
+    if (!g_renderRunning.load(std::memory_order_relaxed)) {
+        g_pendingPhotons.clear(); // no frame will show these
+        return;
+    }
+    std::uint64_t sequence = ++g_snapshotSequence;
+    for (double pressTime : g_pendingPhotons) {
+        if (!g_photonQueue.push({ pressTime, sequence }))
+            break; // render thread stalled; these presses go unmeasured
+    }
+    g_pendingPhotons.clear();
+
+    BoardSnapshot& board = g_boardSnapshots.back();
+    board.sequence = sequence;
+    std::copy(g_keyStates.target.begin(), g_keyStates.target.end(), board.target.begin());
+    std::copy(g_keyStates.keycapRemoved.begin(), g_keyStates.keycapRemoved.end(), board.keycapRemoved.begin());
+    std::copy(g_keyStates.changeTime.begin(), g_keyStates.changeTime.end(), board.changeTime.begin());
+    std::copy(g_keyStates.startAnim.begin(), g_keyStates.startAnim.end(), board.startAnim.begin());
+    std::copy(g_keyStates.heat.begin(), g_keyStates.heat.end(), board.heat.begin());
+    g_boardSnapshots.publish();
+
+    {
+        std::lock_guard<std::mutex> lock(g_wakeMutex);
+        g_wakePending = true;
+    }
+    g_wake.notify_one();
+}
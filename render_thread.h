@@ -0,0 +1,34 @@
+// render_thread.h
+// Drawing on a thread of its own, so a slow frame never holds up input: the
+// main thread only pumps GLFW events (callbacks, hot reload, replay) and
+// publishes the board's key animations and keycaps through a triple buffer.
+// The render thread owns the GL context, evaluates the animations at each
+// frame's time, draws, swaps and records input-to-photon latency. It sleeps while
+// nothing moves and wakes when a new snapshot is published.
+
+#pragma once
+
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+struct RenderSettings {
+    bool vsync = true;
+    double minFrameTime = 0.0;      // seconds between frames while animating, 0 = uncapped
+    bool latencyOverlay = false;    // draw formatLatencyReport() over the board
+    glm::vec3 overlayColor = glm::vec3(1.0f);
+};
+
+// Starts the render thread on window's context, which must not be current
+// on any thread. The board (keyboardKeys, meshes, key states) must be set up;
+// its current state is the first frame. Returns false after logging an error.
+bool startRenderThread(GLFWwindow* window, const RenderSettings& settings);
+
+// Finishes the frame in progress, releases the context and joins the thread.
+// Make the context current on the caller to change GL state (layout reload),
+// then release it and start the thread again.
+void stopRenderThread();
+
+// Main thread, after processing events: hands the current key animations,
+// keycaps and pending press times to the render thread and wakes it. Never
+// blocks on rendering and does not allocate.
+void publishBoardState();
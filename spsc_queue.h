@@ -0,0 +1,64 @@
+// spsc_queue.h
+// Fixed-capacity single-producer / single-consumer ring buffer.
+// push() and pop() are wait-free, never allocate and never block, so the
+// queue can sit between a GLFW callback and a real-time audio callback.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+template <typename T, std::size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Producer side. Returns false (and drops the item) when the queue is full.
+    bool push(const T& item) {
+        std::size_t h = head.load(std::memory_order_relaxed);
+        if (h - tailCache == Capacity) {
+            tailCache = tail.load(std::memory_order_acquire);
+            if (h - tailCache == Capacity)
+                return false;
+        }
+        items[h & (Capacity - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Producer side: pushes as many of count items as fit, published together
+    // with one store. Returns how many were pushed; the rest are dropped.
+    std::size_t pushBatch(const T* batch, std::size_t count) {
+        std::size_t h = head.load(std::memory_order_relaxed);
+        if (Capacity - (h - tailCache) < count)
+            tailCache = tail.load(std::memory_order_acquire);
+        std::size_t room = Capacity - (h - tailCache);
+        std::size_t n = count < room ? count : room;
+        for (std::size_t i = 0; i < n; i++)
+            items[(h + i) & (Capacity - 1)] = batch[i];
+        head.store(h + n, std::memory_order_release);
+        return n;
+    }
+
+    // Consumer side. Returns false when the queue is empty.
+    bool pop(T& out) {
+        std::size_t t = tail.load(std::memory_order_relaxed);
+        if (t == headCache) {
+            headCache = head.load(std::memory_order_acquire);
+            if (t == headCache)
+                return false;
+        }
+        out = items[t & (Capacity - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    // Producer and consumer indices live on separate cache lines; each side
+    // keeps a cached copy of the other's index to avoid needless cross-core traffic.
+    alignas(64) std::atomic<std::size_t> head{ 0 };
+    std::size_t tailCache = 0;
+    alignas(64) std::atomic<std::size_t> tail{ 0 };
+    std::size_t headCache = 0;
+    alignas(64) T items[Capacity];
+};
@@ -0,0 +1,47 @@
+// switch_profiles.cpp
+// See switch_profiles.h. The looks come from the simulators the switches
+// started in: every one of them drew a mid-grey housing, mx_green drew a
+// taller stem that compresses like the keycap bevel.
+
+#include "switch_profiles.h"
+
+static SwitchProfile makeProfile(const ClickPatch& sound, const glm::vec3& stemColor, const StemGeometry& stem) {
+    SwitchProfile profile;
+    profile.sound = sound;
+    profile.stemColor = stemColor;
+    profile.stem = stem;
+    return profile;
+}
+
+const SwitchProfile* builtinSwitchProfiles() {
+    // full_board.cpp: drawMechanicalSwitch3D's forest-green stem
+    static const StemGeometry RIGID_STEM = { 0.56f, 0.7143f, 0.0f };
+    // mx_green: cloneDepth = animDepth * cloneScale * 1.5 * (1 - 0.5 * pressAnim)
+    static const StemGeometry TALL_STEM = { 0.56f, 1.5f, 0.5f };
+
+    static const SwitchProfile profiles[SWITCH_PROFILE_COUNT] = {
+        makeProfile(makeUltraCrispClickPatch(), glm::vec3(0.1f, 0.4f, 0.1f), RIGID_STEM),
+        makeProfile(makeBlueSwitchPatch(), glm::vec3(0.1f, 0.25f, 0.6f), RIGID_STEM),
+        makeProfile(makeGreenSwitchPatch(), glm::vec3(0.1f, 0.4f, 0.1f), TALL_STEM)
+    };
+    return profiles;
+}
+
+void loadSwitchProfiles(const std::string& patchDir, SwitchProfile* out) {
+    ClickPatch sounds[CLICK_PATCH_COUNT];
+    loadClickPatches(patchDir, sounds);
+    const SwitchProfile* builtin = builtinSwitchProfiles();
+    for (int i = 0; i < SWITCH_PROFILE_COUNT; i++) {
+        out[i] = builtin[i];
+        out[i].sound = sounds[i];
+    }
+}
+
+void collectClickPatches(const SwitchProfile* profiles, int count, ClickPatch* patches) {
+    for (int i = 0; i < count; i++)
+        patches[i] = profiles[i].sound;
+}
+
+int findSwitchProfile(const char* name) {
+    return findClickPatch(name);
+}
@@ -0,0 +1,46 @@
+// switch_profiles.h
+// A switch profile is one switch type: the click it plays and how its housing
+// and stem are drawn. Keys pick a profile by id (Key::switchId, set by the
+// layout's "switch" directive), so a board can mix switch types while every
+// key still goes through one render batch and one audio voice pool.
+//
+// Profile ids are ClickPatchId values and profile names are the patch names
+// ("ultra_crisp", "mx_blue", "mx_green"), so a switch id doubles as the
+// KeyEvent::patchIndex the audio engine plays.
+
+#pragma once
+
+#include "click_patches.h"
+
+#include <glm/glm.hpp>
+#include <string>
+
+constexpr int SWITCH_PROFILE_COUNT = CLICK_PATCH_COUNT;
+
+// Stem shape relative to the housing it sits in
+struct StemGeometry {
+    float scale = 0.56f;    // footprint as a fraction of the housing's
+    float depth = 0.7143f;  // bevel depth as a fraction of (housing depth - 6) * scale
+    float compress = 0.0f;  // fraction of the bevel squeezed out per unit of pressAnim
+};
+
+struct SwitchProfile {
+    ClickPatch sound;
+    glm::vec3 housingColor = glm::vec3(0.5f);
+    glm::vec3 stemColor = glm::vec3(0.1f, 0.4f, 0.1f);
+    StemGeometry stem;
+};
+
+// All built-in profiles, indexed by ClickPatchId.
+const SwitchProfile* builtinSwitchProfiles();
+
+// The built-in profiles with their sounds taken from <patchDir>/<name>.patch
+// (see loadClickPatches). out must hold SWITCH_PROFILE_COUNT profiles.
+void loadSwitchProfiles(const std::string& patchDir, SwitchProfile* out);
+
+// Copies the sound of each profile into patches, in profile order, for the
+// audio engine.
+void collectClickPatches(const SwitchProfile* profiles, int count, ClickPatch* patches);
+
+// Profile id for a layout-file name, or -1.
+int findSwitchProfile(const char* name);
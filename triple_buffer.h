@@ -0,0 +1,49 @@
+// triple_buffer.h
+// Single-writer / single-reader triple buffer: the writer fills one slot and
+// publishes it, the reader picks up the newest published slot, and neither
+// ever waits for the other. Values the reader did not get to in time are
+// replaced, so it suits state (the latest wins), not events.
+
+#pragma once
+
+#include <atomic>
+
+template <typename T>
+class TripleBuffer {
+public:
+    // Setup: copies value into every slot. Only while neither side is running.
+    void reset(const T& value) {
+        for (T& slot : slots)
+            slot = value;
+        backIndex = 0;
+        middle.store(1, std::memory_order_relaxed);
+        frontIndex = 2;
+    }
+
+    // Writer side: fill back(), then publish() it. back() then refers to a
+    // different slot with stale contents, so rewrite all of it each time.
+    T& back() { return slots[backIndex]; }
+    void publish() {
+        backIndex = middle.exchange(backIndex | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Reader side: returns true and moves front() to the newest value if one
+    // was published since the last call.
+    bool acquire() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH))
+            return false;
+        frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+    const T& front() const { return slots[frontIndex]; }
+
+private:
+    static constexpr unsigned INDEX_MASK = 3;
+    static constexpr unsigned FRESH = 4; // set while the middle slot is unread
+
+    T slots[3];
+    // Writer and reader indices on separate cache lines from the shared one
+    alignas(64) unsigned backIndex = 0;
+    alignas(64) std::atomic<unsigned> middle{ 1 };
+    alignas(64) unsigned frontIndex = 2;
+};
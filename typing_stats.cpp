@@ -0,0 +1,249 @@
+// typing_stats.cpp
+// See typing_stats.h.
+
+#include "typing_stats.h"
+
+#include "latency_stats.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+// -------------------------
+// Counters
+// -------------------------
+constexpr double TYPING_FLUSH_INTERVAL = 5.0; // seconds between snapshots on disk
+
+// Written by the input thread only; read by the writer
+struct KeyTypingCounters {
+    std::atomic<std::uint32_t> presses{ 0 };
+    std::atomic<std::uint32_t> dwellCount{ 0 };
+    std::atomic<double> dwellTotal{ 0.0 };
+    std::atomic<std::uint32_t> dwellBuckets[LATENCY_BUCKET_COUNT] = {};
+};
+
+struct TypingStats {
+    bool running = false;
+    std::vector<KeyTypingCounters> keys;
+    std::atomic<std::uint32_t> intervalBuckets[LATENCY_BUCKET_COUNT] = {};
+    std::atomic<std::uint32_t> totalPresses{ 0 };
+
+    // Input thread only
+    std::vector<double> pressStart;     // per key, while held
+    double lastPressTime = -1.0;
+    std::uint32_t heatScale = 0;        // heatmap scale, a power of two
+
+    // Writer thread
+    std::string path;
+    std::vector<std::string> labels;
+    std::chrono::steady_clock::time_point startTime;
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    bool reportedFailure = false;
+};
+
+static TypingStats g_typing;
+
+// Single writer, so a plain load and store instead of a locked add
+static void bump(std::atomic<std::uint32_t>& counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+// -------------------------
+// Snapshot File
+// -------------------------
+// Bucket bound at quantile q of count samples
+static float histogramQuantile(const std::uint32_t* buckets, std::uint32_t count, double q) {
+    if (count == 0)
+        return 0.0f;
+    std::uint32_t rank = static_cast<std::uint32_t>(q * count);
+    if (rank < 1)
+        rank = 1;
+    std::uint32_t seen = 0;
+    for (int b = 0; b < LATENCY_BUCKET_COUNT; b++) {
+        seen += buckets[b];
+        if (seen >= rank)
+            return static_cast<float>(latencyBucketUpperBound(b));
+    }
+    return static_cast<float>(latencyBucketUpperBound(LATENCY_BUCKET_COUNT - 1));
+}
+
+template <typename T>
+static bool writeColumn(std::FILE* file, const std::vector<T>& column) {
+    return column.empty() || std::fwrite(column.data(), sizeof(T), column.size(), file) == column.size();
+}
+
+// Writer thread: copies the counters into columns and replaces the file
+static bool writeSnapshot() {
+    std::size_t keyCount = g_typing.keys.size();
+    std::vector<std::uint32_t> labelOffset(keyCount + 1, 0);
+    std::vector<char> labelBytes;
+    std::vector<std::uint32_t> presses(keyCount);
+    std::vector<float> dwellMean(keyCount), dwellP50(keyCount), dwellP90(keyCount);
+    std::vector<std::uint32_t> dwellHist(keyCount * LATENCY_BUCKET_COUNT);
+    std::vector<std::uint32_t> intervalHist(LATENCY_BUCKET_COUNT);
+
+    for (std::size_t i = 0; i < keyCount; i++) {
+        const std::string& label = g_typing.labels[i];
+        labelBytes.insert(labelBytes.end(), label.begin(), label.end());
+        labelOffset[i + 1] = static_cast<std::uint32_t>(labelBytes.size());
+
+        const KeyTypingCounters& k = g_typing.keys[i];
+        presses[i] = k.presses.load(std::memory_order_relaxed);
+        std::uint32_t* hist = &dwellHist[i * LATENCY_BUCKET_COUNT];
+        std::uint32_t dwells = 0;
+        for (int b = 0; b < LATENCY_BUCKET_COUNT; b++) {
+            hist[b] = k.dwellBuckets[b].load(std::memory_order_relaxed);
+            dwells += hist[b];
+        }
+        std::uint32_t dwellCount = k.dwellCount.load(std::memory_order_relaxed);
+        dwellMean[i] = dwellCount ? static_cast<float>(k.dwellTotal.load(std::memory_order_relaxed) / dwellCount) : 0.0f;
+        dwellP50[i] = histogramQuantile(hist, dwells, 0.5);
+        dwellP90[i] = histogramQuantile(hist, dwells, 0.9);
+    }
+    for (int b = 0; b < LATENCY_BUCKET_COUNT; b++)
+        intervalHist[b] = g_typing.intervalBuckets[b].load(std::memory_order_relaxed);
+
+    TypingStatsHeader header = {};
+    header.magic[0] = 'Q'; header.magic[1] = 'G'; header.magic[2] = 'T'; header.magic[3] = 'S';
+    header.version = TYPING_STATS_VERSION;
+    header.keyCount = static_cast<std::uint32_t>(keyCount);
+    header.bucketCount = LATENCY_BUCKET_COUNT;
+    header.sessionSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - g_typing.startTime).count();
+    header.totalPresses = g_typing.totalPresses.load(std::memory_order_relaxed);
+
+    // Written aside and renamed over the old file, so readers never see half
+    std::string temporary = g_typing.path + ".tmp";
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (!file)
+        return false;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1
+        && writeColumn(file, labelOffset) && writeColumn(file, labelBytes)
+        && writeColumn(file, presses) && writeColumn(file, dwellMean)
+        && writeColumn(file, dwellP50) && writeColumn(file, dwellP90)
+        && writeColumn(file, dwellHist) && writeColumn(file, intervalHist);
+    ok = std::fclose(file) == 0 && ok;
+    std::error_code ec;
+    if (ok)
+        std::filesystem::rename(temporary, g_typing.path, ec);
+    return ok && !ec;
+}
+
+static void flushSnapshot() {
+    if (writeSnapshot() || g_typing.reportedFailure)
+        return;
+    std::cerr << "Warning: Could not write typing stats " << g_typing.path << "\n";
+    g_typing.reportedFailure = true;
+}
+
+static void writerLoop() {
+    std::unique_lock<std::mutex> lock(g_typing.mutex);
+    while (!g_typing.stopping) {
+        g_typing.wake.wait_for(lock, std::chrono::duration<double>(TYPING_FLUSH_INTERVAL),
+            [] { return g_typing.stopping; });
+        lock.unlock();
+        flushSnapshot(); // the last one runs after stopping was set
+        lock.lock();
+    }
+}
+
+// -------------------------
+// Public Interface
+// -------------------------
+bool startTypingStats(const std::vector<Key>& keys, const std::string& path) {
+    if (g_typing.running)
+        stopTypingStats();
+    g_typing.keys = std::vector<KeyTypingCounters>(keys.size());
+    for (auto& bucket : g_typing.intervalBuckets)
+        bucket.store(0, std::memory_order_relaxed);
+    g_typing.totalPresses.store(0, std::memory_order_relaxed);
+    g_typing.pressStart.assign(keys.size(), -1.0);
+    g_typing.lastPressTime = -1.0;
+    g_typing.heatScale = 0;
+    g_typing.path = path;
+    g_typing.labels.clear();
+    for (const Key& k : keys)
+        g_typing.labels.push_back(k.label);
+    g_typing.startTime = std::chrono::steady_clock::now();
+    g_typing.stopping = false;
+    g_typing.reportedFailure = false;
+    g_typing.running = true;
+
+    if (path.empty())
+        return true;
+    try {
+        g_typing.writer = std::thread(writerLoop);
+    }
+    catch (const std::system_error&) {
+        std::cerr << "Error: Failed to start the typing stats writer\n";
+        return false;
+    }
+    return true;
+}
+
+void stopTypingStats() {
+    if (!g_typing.running)
+        return;
+    if (g_typing.writer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(g_typing.mutex);
+            g_typing.stopping = true;
+        }
+        g_typing.wake.notify_one();
+        g_typing.writer.join();
+    }
+    g_typing.running = false;
+}
+
+void noteTypingPress(int keyIndex, double time) {
+    if (!g_typing.running || keyIndex < 0 || keyIndex >= static_cast<int>(g_typing.keys.size()))
+        return;
+    bump(g_typing.keys[keyIndex].presses);
+    bump(g_typing.totalPresses);
+    if (g_typing.lastPressTime >= 0.0 && time >= g_typing.lastPressTime)
+        bump(g_typing.intervalBuckets[latencyBucket(time - g_typing.lastPressTime)]);
+    g_typing.lastPressTime = time;
+    g_typing.pressStart[keyIndex] = time;
+}
+
+void noteTypingRelease(int keyIndex, double time) {
+    if (!g_typing.running || keyIndex < 0 || keyIndex >= static_cast<int>(g_typing.keys.size()))
+        return;
+    double start = g_typing.pressStart[keyIndex];
+    if (start < 0.0 || time < start)
+        return;
+    g_typing.pressStart[keyIndex] = -1.0;
+    KeyTypingCounters& k = g_typing.keys[keyIndex];
+    double dwell = time - start;
+    bump(k.dwellBuckets[latencyBucket(dwell)]);
+    k.dwellTotal.store(k.dwellTotal.load(std::memory_order_relaxed) + dwell, std::memory_order_relaxed);
+    bump(k.dwellCount);
+}
+
+void updateTypingHeat(std::vector<float>& heat, int keyIndex) {
+    if (!g_typing.running || keyIndex < 0 || keyIndex >= static_cast<int>(g_typing.keys.size()))
+        return;
+    std::uint32_t presses = g_typing.keys[keyIndex].presses.load(std::memory_order_relaxed);
+    if (presses > g_typing.heatScale) {
+        // Past the scale: double it, and every share moves. Doing that only
+        // at powers of two keeps whole-board rewrites to a handful per run.
+        std::uint32_t scale = g_typing.heatScale ? g_typing.heatScale : 1;
+        while (scale < presses)
+            scale *= 2;
+        g_typing.heatScale = scale;
+        float inverse = 1.0f / static_cast<float>(scale);
+        for (std::size_t i = 0; i < g_typing.keys.size() && i < heat.size(); i++)
+            heat[i] = static_cast<float>(g_typing.keys[i].presses.load(std::memory_order_relaxed)) * inverse;
+    }
+    else if (static_cast<std::size_t>(keyIndex) < heat.size()) {
+        heat[keyIndex] = static_cast<float>(presses) / static_cast<float>(g_typing.heatScale);
+    }
+}
@@ -0,0 +1,66 @@
+// typing_stats.h
+// Typing analytics: per-key press counts and dwell times (press -> release),
+// and the interval between consecutive presses of any key. Everything is
+// aggregated as it happens into fixed per-key counters and log-scale
+// histograms (latency_stats.h buckets), written by the input thread with
+// relaxed single-writer stores: no allocation, no locks, no syscalls. A
+// writer thread snapshots them to disk every few seconds and on stop, so
+// file I/O never reaches input handling.
+//
+// File: TypingStatsHeader, then whole columns, each keyCount (or
+// bucketCount) values long, in this order:
+//   labelOffset u32[keyCount + 1]  into the label bytes that follow
+//   label bytes char[labelOffset[keyCount]]
+//   presses     u32[keyCount]
+//   dwellMean   f32[keyCount]      seconds, 0 without a release yet
+//   dwellP50    f32[keyCount]      seconds, bucket upper bound
+//   dwellP90    f32[keyCount]
+//   dwellHist   u32[keyCount][bucketCount]
+//   intervalHist u32[bucketCount]
+// Bucket b holds times up to 2^(b / 4) microseconds (latencyBucketUpperBound).
+// The file is replaced whole on every flush.
+
+#pragma once
+
+#include "keyboard.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+constexpr std::uint32_t TYPING_STATS_VERSION = 1;
+
+struct TypingStatsHeader {
+    char magic[4];                  // "QGTS"
+    std::uint32_t version;          // TYPING_STATS_VERSION
+    std::uint32_t keyCount;
+    std::uint32_t bucketCount;      // LATENCY_BUCKET_COUNT
+    double sessionSeconds;          // wall time since startTypingStats()
+    std::uint32_t totalPresses;
+    std::uint32_t reserved;
+};
+
+static_assert(sizeof(TypingStatsHeader) == 32, "TypingStatsHeader is written to disk as is");
+
+// Starts counting for keys (the current layout). With a path, a writer
+// thread flushes there every few seconds; with an empty one the counters
+// only feed the heatmap. Returns false after logging an error (counting then
+// still runs, unflushed).
+bool startTypingStats(const std::vector<Key>& keys, const std::string& path);
+
+// Writes a last snapshot (when flushing) and stops counting. Call before the
+// layout's keys change, then start again for the new layout; the file then
+// covers the new layout only.
+void stopTypingStats();
+
+// Input thread, from keyCallback: the press that took a key down, and the
+// release that let it up. No-ops while stopped.
+void noteTypingPress(int keyIndex, double time);
+void noteTypingRelease(int keyIndex, double time);
+
+// Heatmap tint: heat[i] becomes key i's presses over a scale, 0..1. The scale
+// is the smallest power of two covering the most pressed key, so the hottest
+// key reads 0.5..1 and all keys move only when it crosses the next one; any
+// other press rewrites just its own key. Call after noteTypingPress(keyIndex).
+// heat must hold every key.
+void updateTypingHeat(std::vector<float>& heat, int keyIndex);